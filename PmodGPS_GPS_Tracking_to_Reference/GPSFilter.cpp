@@ -0,0 +1,315 @@
+/************************************************************************/
+/*																		*/
+/*	GPSFilter.cpp  Position smoothing for the PmodGPS fix stream		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include <math.h>
+#include "GPSFilter.h"
+
+#define MS_PER_DAY			86400000L
+#define DOP_UNKNOWN			2.0f	//Used when the receiver has not sent a DOP yet
+#define VDOP_PER_HDOP		1.5f	//Used for altitude when there is no VDOP
+#define INIT_VEL_VARIANCE	100.0f	//(m/s)^2, the first velocity is a guess of 0
+#define DEG_TO_RAD_F		0.0174532925f
+
+/* ------------------------------------------------------------ */
+/*  GPSFilter()
+**
+**  Description:
+**    Starts with the filter off.
+*/
+GPSFilter::GPSFilter()
+{
+	mode = FILTER_OFF;
+	reset();
+}
+
+/* ------------------------------------------------------------ */
+/*  setMode(), getMode()
+**
+**  Parameters:
+**	  newMode: FILTER_OFF, FILTER_ALPHA_BETA or FILTER_KALMAN
+**
+**  Description:
+**    Changing the mode starts the filter over from the next fix.
+*/
+void GPSFilter::setMode(FILTER_MODE newMode)
+{
+	if (newMode != mode){
+		mode = newMode;
+		reset();
+	}
+}
+
+FILTER_MODE GPSFilter::getMode()
+{
+	return mode;
+}
+
+/* ------------------------------------------------------------ */
+/*  reset(), isValid()
+**
+**  Description:
+**    After reset() the next position is taken as it is and the
+**	  filter is not valid until then. The filter also starts over
+**	  when no position has arrived for FILTER_TIMEOUT.
+*/
+void GPSFilter::reset()
+{
+	valid = false;
+	velocityUsed = false;
+	utc = 0;
+}
+
+bool GPSFilter::isValid()
+{
+	return valid;
+}
+
+/* ------------------------------------------------------------ */
+/*  updatePosition()
+**
+**  Parameters:
+**	  latE7, lonE7: position in 1e-7 degrees
+**	  altCm: altitude in cm
+**	  utc: time of the position, ms since midnight
+**	  hdop, vdop: dilution of precision x100, 0 if not known
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    Does nothing when the mode is FILTER_OFF
+**
+**  Description:
+**    Moves the state forward to the time of the position and
+**	  corrects it with the position. A larger DOP gives the position
+**	  less weight. The origin is moved to the estimate once that is
+**	  FILTER_REANCHOR away, so the flat earth offsets stay accurate.
+*/
+void GPSFilter::updatePosition(int32_t latE7, int32_t lonE7, int32_t altCm, uint32_t newUtc, uint16_t hdop, uint16_t vdop)
+{
+	float h = hdop ? hdop / 100.0f : DOP_UNKNOWN;
+	float v = vdop ? vdop / 100.0f : h * VDOP_PER_HDOP;
+	float hVariance = (h * FILTER_UERE) * (h * FILTER_UERE);
+	float vVariance = (v * FILTER_UERE) * (v * FILTER_UERE);
+	float gainScale = h > 1 ? 1 / h : 1;
+	float e, n, dt;
+	int32_t elapsed;
+
+	if (mode == FILTER_OFF){
+		return;
+	}
+
+	elapsed = (int32_t)(newUtc - utc);
+	if (elapsed < -(MS_PER_DAY / 2)){//Past midnight
+		elapsed += MS_PER_DAY;
+	}
+	if (!valid || elapsed < 0 || elapsed > FILTER_TIMEOUT){
+		geoSetReference(&origin, latE7, lonE7);
+		start(&east, 0, hVariance);
+		start(&north, 0, hVariance);
+		start(&up, altCm / 100.0f, vVariance);
+		utc = newUtc;
+		valid = true;
+		velocityUsed = false;
+		return;
+	}
+
+	dt = elapsed / 1000.0f;
+	geoOffset(&origin, latE7, lonE7, &e, &n);
+	predict(&east, dt);
+	predict(&north, dt);
+	predict(&up, dt);
+	measurePosition(&east, e, hVariance, dt, gainScale);
+	measurePosition(&north, n, hVariance, dt, gainScale);
+	measurePosition(&up, altCm / 100.0f, vVariance, dt, gainScale);
+	utc = newUtc;
+	velocityUsed = false;
+
+	if (fabsf(east.POS) > FILTER_REANCHOR || fabsf(north.POS) > FILTER_REANCHOR){
+		int32_t lat, lon;
+
+		geoPosition(&origin, east.POS, north.POS, &lat, &lon);
+		geoSetReference(&origin, lat, lon);
+		east.POS = 0;
+		north.POS = 0;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  updateVelocity()
+**
+**  Parameters:
+**	  speed: speed over ground, mm/s
+**	  course: course over ground, 0.01 degrees from true north
+**	  hdop: dilution of precision x100, 0 if not known
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    Ignored before the first position, and after the first
+**	  velocity following a position so a speed sent in both RMC and
+**	  VTG is not counted twice
+**
+**  Description:
+**    Corrects the east and north velocity, and through the
+**	  covariance the position as well.
+*/
+void GPSFilter::updateVelocity(uint32_t speed, uint16_t course, uint16_t hdop)
+{
+	float h = hdop ? hdop / 100.0f : DOP_UNKNOWN;
+	float variance = (h * FILTER_VEL_UERE) * (h * FILTER_VEL_UERE);
+	float gainScale = h > 1 ? 1 / h : 1;
+	float metres = speed / 1000.0f;
+	float radians = course / 100.0f * DEG_TO_RAD_F;
+
+	if (mode == FILTER_OFF || !valid || velocityUsed){
+		return;
+	}
+	measureVelocity(&east, metres * sinf(radians), variance, gainScale);
+	measureVelocity(&north, metres * cosf(radians), variance, gainScale);
+	velocityUsed = true;
+}
+
+/* ------------------------------------------------------------ */
+/*  getState()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    The filtered position, altitude and velocity in FIX units
+**
+**  Errors:
+**    All zero until isValid()
+*/
+FILTER_STATE GPSFilter::getState()
+{
+	FILTER_STATE state = {0, 0, 0, 0, 0, 0, 0};
+	float hacc;
+	float bearing;
+
+	if (!valid){
+		return state;
+	}
+	geoPosition(&origin, east.POS, north.POS, &state.LAT, &state.LON);
+	state.ALT = (int32_t)lroundf(up.POS * 100);
+	state.SPEED = (uint32_t)(sqrtf(east.VEL * east.VEL + north.VEL * north.VEL) * 1000 + 0.5f);
+	bearing = geoBearing(east.VEL, north.VEL) * 100 + 0.5f;
+	state.COURSE = bearing < 36000 ? (uint16_t)bearing : 0;
+	state.UTC = utc;
+	if (mode == FILTER_KALMAN){
+		hacc = sqrtf(east.P00 + north.P00) * 100;
+		state.HACC = hacc < 65535 ? (uint16_t)hacc : 65535;
+	}
+	return state;
+}
+
+/* ------------------------------------------------------------ */
+/*					Private Functions							*/
+
+/* ------------------------------------------------------------ */
+/*  start()
+**
+**  Description:
+**    Takes a measured position as it is, with no velocity.
+*/
+void GPSFilter::start(FILTER_AXIS* axis, float z, float variance)
+{
+	axis->POS = z;
+	axis->VEL = 0;
+	axis->P00 = variance;
+	axis->P01 = 0;
+	axis->P11 = INIT_VEL_VARIANCE;
+}
+
+/* ------------------------------------------------------------ */
+/*  predict()
+**
+**  Description:
+**    Moves an axis forward by dt seconds at constant velocity. The
+**	  Kalman covariance grows by the white acceleration noise
+**	  FILTER_ACCEL.
+*/
+void GPSFilter::predict(FILTER_AXIS* axis, float dt)
+{
+	float q = FILTER_ACCEL * FILTER_ACCEL;
+	float dt2 = dt * dt;
+
+	axis->POS += axis->VEL * dt;
+	if (mode == FILTER_KALMAN){
+		axis->P00 += dt * (2 * axis->P01 + dt * axis->P11) + q * dt2 * dt2 / 4;
+		axis->P01 += dt * axis->P11 + q * dt2 * dt / 2;
+		axis->P11 += q * dt2;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  measurePosition()
+**
+**  Description:
+**    Corrects an axis with a position measurement. FILTER_KALMAN
+**	  works out the gains from the covariance and variance,
+**	  FILTER_ALPHA_BETA uses the fixed gains times gainScale.
+*/
+void GPSFilter::measurePosition(FILTER_AXIS* axis, float z, float variance, float dt, float gainScale)
+{
+	float residual = z - axis->POS;
+	float s, k0, k1, p01;
+
+	if (mode == FILTER_KALMAN){
+		s = axis->P00 + variance;
+		k0 = axis->P00 / s;
+		k1 = axis->P01 / s;
+		p01 = axis->P01;
+		axis->POS += k0 * residual;
+		axis->VEL += k1 * residual;
+		axis->P00 -= k0 * axis->P00;
+		axis->P01 -= k0 * p01;
+		axis->P11 -= k1 * p01;
+	}
+	else{
+		axis->POS += FILTER_ALPHA * gainScale * residual;
+		if (dt > 0){
+			axis->VEL += FILTER_BETA * gainScale * residual / dt;
+		}
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  measureVelocity()
+**
+**  Description:
+**    As measurePosition() for a velocity measurement. The alpha-beta
+**	  filter blends the velocity in with FILTER_ALPHA.
+*/
+void GPSFilter::measureVelocity(FILTER_AXIS* axis, float z, float variance, float gainScale)
+{
+	float residual = z - axis->VEL;
+	float s, k0, k1, p01, p11;
+
+	if (mode == FILTER_KALMAN){
+		s = axis->P11 + variance;
+		k0 = axis->P01 / s;
+		k1 = axis->P11 / s;
+		p01 = axis->P01;
+		p11 = axis->P11;
+		axis->POS += k0 * residual;
+		axis->VEL += k1 * residual;
+		axis->P00 -= k0 * p01;
+		axis->P01 -= k0 * p11;
+		axis->P11 -= k1 * p11;
+	}
+	else{
+		axis->VEL += FILTER_ALPHA * gainScale * residual;
+	}
+}
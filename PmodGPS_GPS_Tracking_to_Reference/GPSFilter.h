@@ -0,0 +1,99 @@
+/************************************************************************/
+/*																		*/
+/*	GPSFilter.h  Position smoothing for the PmodGPS fix stream			*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Smooths the GGA positions with a constant velocity model on each	*/
+/*	of the east, north and up axes, in metres from an origin near the	*/
+/*	unit. Two modes are offered:										*/
+/*	  FILTER_KALMAN		a 2 state Kalman filter per axis. Position		*/
+/*						noise follows the HDOP (VDOP for altitude),		*/
+/*						the VTG/RMC speed and course are fused as a		*/
+/*						velocity measurement							*/
+/*	  FILTER_ALPHA_BETA	fixed gains, scaled down when the HDOP is		*/
+/*						above 1. About a third of the work				*/
+/*	Each fix takes constant time and the state is about 100 bytes.		*/
+/*	Does not depend on Arduino.h so it can also be built on a host		*/
+/*	computer.															*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSFilter_H
+#define GPSFilter_H
+
+#include <stdint.h>
+#include "GPSgeo.h"
+
+#define FILTER_UERE			5.0f	//Position error at DOP 1, metres
+#define FILTER_VEL_UERE		0.2f	//Velocity error at DOP 1, m/s
+#define FILTER_ACCEL		1.0f	//Process noise, expected acceleration in m/s^2
+#define FILTER_ALPHA		0.5f	//FILTER_ALPHA_BETA position gain
+#define FILTER_BETA			0.2f	//FILTER_ALPHA_BETA velocity gain
+#define FILTER_TIMEOUT		10000	//ms without a fix after which the filter starts over
+#define FILTER_REANCHOR		10000.0f	//metres from the origin after which it is moved
+
+typedef enum{
+	FILTER_OFF,
+	FILTER_ALPHA_BETA,
+	FILTER_KALMAN
+}FILTER_MODE;
+
+//One axis of the constant velocity model
+typedef struct FILTER_AXIS_T{
+	float POS;		//metres from the origin
+	float VEL;		//metres per second
+	float P00;		//Covariance of POS
+	float P01;		//Covariance of POS and VEL
+	float P11;		//Covariance of VEL
+}FILTER_AXIS;
+
+//Filtered state in the units of FIX
+typedef struct FILTER_STATE_T{
+	int32_t LAT;		//1e-7 degrees
+	int32_t LON;		//1e-7 degrees
+	int32_t ALT;		//cm
+	uint32_t SPEED;		//mm/s
+	uint32_t UTC;		//ms since midnight of the last position used
+	uint16_t COURSE;	//0.01 degrees from true north
+	uint16_t HACC;		//Estimated horizontal error, cm, 0 for FILTER_ALPHA_BETA
+}FILTER_STATE;
+
+class GPSFilter
+{
+	public:
+	GPSFilter();
+
+	void setMode(FILTER_MODE newMode);
+	FILTER_MODE getMode();
+	void reset();
+	bool isValid();
+
+	void updatePosition(int32_t latE7, int32_t lonE7, int32_t altCm, uint32_t utc, uint16_t hdop, uint16_t vdop);
+	void updateVelocity(uint32_t speed, uint16_t course, uint16_t hdop);
+	FILTER_STATE getState();
+
+	private:
+	void predict(FILTER_AXIS* axis, float dt);
+	void measurePosition(FILTER_AXIS* axis, float z, float variance, float dt, float gainScale);
+	void measureVelocity(FILTER_AXIS* axis, float z, float variance, float gainScale);
+	void start(FILTER_AXIS* axis, float z, float variance);
+
+	FILTER_MODE mode;
+	bool valid;
+	bool velocityUsed;		//A velocity has been fused since the last position
+	GEO_REF origin;			//Position the axes are measured from
+	FILTER_AXIS east;
+	FILTER_AXIS north;
+	FILTER_AXIS up;
+	uint32_t utc;			//Time of the last position, ms since midnight
+};
+
+#endif //GPSFilter_H
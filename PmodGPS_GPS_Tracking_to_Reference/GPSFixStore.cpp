@@ -0,0 +1,267 @@
+/************************************************************************/
+/*																		*/
+/*	GPSFixStore.cpp  Last good fix kept in EEPROM across restarts		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "GPSFixStore.h"
+
+/* ------------------------------------------------------------ */
+/*  Slot helpers
+**
+**  Description:
+**    Slots are written byte by byte in little endian order so the
+**	  layout does not depend on the compiler.
+*/
+static void put32(uint8_t* p, uint32_t value)
+{
+	p[0] = (uint8_t)value;
+	p[1] = (uint8_t)(value >> 8);
+	p[2] = (uint8_t)(value >> 16);
+	p[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t get32(const uint8_t* p)
+{
+	return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+/* ------------------------------------------------------------ */
+/*  storeCRC8()
+**
+**  Parameters:
+**	  data, size: the bytes to check
+**
+**  Return Value:
+**    CRC-8 with polynomial 0x07, starting from 0xFF so that neither
+**	  an erased (0xFF) nor a zeroed slot has a matching CRC.
+*/
+uint8_t storeCRC8(const uint8_t* data, uint8_t size)
+{
+	uint8_t crc = 0xFF;
+	uint8_t i;
+
+	while (size--){
+		crc ^= *data++;
+		for (i = 0; i < 8; i++){
+			crc = (crc & 0x80) ? (uint8_t)(crc << 1) ^ 0x07 : (uint8_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+/* ------------------------------------------------------------ */
+/*  GPSFixStore()
+**
+**  Description:
+**    Nothing can be loaded or saved until begin().
+*/
+GPSFixStore::GPSFixStore()
+{
+	reader = 0;
+	writer = 0;
+	storeContext = 0;
+	baseAddress = 0;
+	slots = 0;
+	newest = 0;
+	sequence = 0;
+	found = false;
+	savedOnce = false;
+	savedAt = 0;
+}
+
+/* ------------------------------------------------------------ */
+/*  begin()
+**
+**  Parameters:
+**	  read, write: functions that reach the EEPROM
+**	  context: passed to read and write
+**	  base: first address of the area used
+**	  size: bytes in the area, STORE_SLOT_SIZE for each slot
+**
+**  Return Value:
+**    The number of slots, 0 if size is too small for one
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Scans every slot for the newest one with a good CRC. Sequence
+**	  numbers are compared by their difference, so they can wrap.
+*/
+uint16_t GPSFixStore::begin(STORE_READ read, STORE_WRITE write, void* context, uint16_t base, uint16_t size)
+{
+	uint8_t data[STORE_SLOT_SIZE];
+	uint16_t slotSequence;
+	uint16_t slot;
+
+	reader = read;
+	writer = write;
+	storeContext = context;
+	baseAddress = base;
+	slots = size / STORE_SLOT_SIZE;
+	found = false;
+	savedOnce = false;
+	newest = 0;
+	sequence = 0;
+	for (slot = 0; slot < slots; slot++){
+		if (readSlot(slot, data, &slotSequence) && (!found || (int16_t)(slotSequence - sequence) > 0)){
+			newest = slot;
+			sequence = slotSequence;
+			found = true;
+		}
+	}
+	return slots;
+}
+
+/* ------------------------------------------------------------ */
+/*  readSlot()
+**
+**  Parameters:
+**	  slot: the slot to read
+**	  data: STORE_SLOT_SIZE bytes for the slot
+**	  sequence: set to the slot's sequence number
+**
+**  Return Value:
+**    true if the slot was read and its CRC matched
+*/
+bool GPSFixStore::readSlot(uint16_t slot, uint8_t* data, uint16_t* sequence)
+{
+	if (!reader(storeContext, baseAddress + slot * STORE_SLOT_SIZE, data, STORE_SLOT_SIZE)){
+		return false;
+	}
+	if (storeCRC8(data, STORE_SLOT_SIZE - 1) != data[STORE_SLOT_SIZE - 1]){
+		return false;
+	}
+	*sequence = data[0] | (uint16_t)data[1] << 8;
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  load()
+**
+**  Parameters:
+**	  fix: set to the newest saved fix
+**
+**  Return Value:
+**    false if there is no saved fix, fix is not changed
+**
+**  Errors:
+**    Returns false if the slot can no longer be read.
+*/
+bool GPSFixStore::load(STORED_FIX* fix)
+{
+	uint8_t data[STORE_SLOT_SIZE];
+	uint16_t slotSequence;
+
+	if (!found || !readSlot(newest, data, &slotSequence)){
+		return false;
+	}
+	fix->LAT = (int32_t)get32(data + 2);
+	fix->LON = (int32_t)get32(data + 6);
+	fix->ALT = (int32_t)get32(data + 10);
+	fix->UTC = get32(data + 14);
+	fix->DAY = data[18];
+	fix->MONTH = data[19];
+	fix->YEAR = data[20];
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  save()
+**
+**  Parameters:
+**	  fix: the fix to save
+**
+**  Return Value:
+**    false if there are no slots or the write failed
+**
+**  Errors:
+**    A failed write leaves the fix saved before in use.
+**
+**  Description:
+**    Writes fix to the slot after the newest one, with the next
+**	  sequence number.
+*/
+bool GPSFixStore::save(const STORED_FIX* fix)
+{
+	uint8_t data[STORE_SLOT_SIZE];
+	uint16_t slot = found ? (newest + 1) % slots : 0;
+	uint16_t slotSequence = found ? sequence + 1 : 0;
+
+	if (slots == 0){
+		return false;
+	}
+	data[0] = (uint8_t)slotSequence;
+	data[1] = (uint8_t)(slotSequence >> 8);
+	put32(data + 2, (uint32_t)fix->LAT);
+	put32(data + 6, (uint32_t)fix->LON);
+	put32(data + 10, (uint32_t)fix->ALT);
+	put32(data + 14, fix->UTC);
+	data[18] = fix->DAY;
+	data[19] = fix->MONTH;
+	data[20] = fix->YEAR;
+	data[STORE_SLOT_SIZE - 1] = storeCRC8(data, STORE_SLOT_SIZE - 1);
+	if (!writer(storeContext, baseAddress + slot * STORE_SLOT_SIZE, data, STORE_SLOT_SIZE)){
+		return false;
+	}
+	newest = slot;
+	sequence = slotSequence;
+	found = true;
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  update()
+**
+**  Parameters:
+**	  fix: the latest good fix
+**	  now: the time in ms, millis()
+**	  interval: the least ms between saves
+**
+**  Return Value:
+**    true if fix was saved
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Call with every good fix. The first one after begin() is saved
+**	  at once, then one every interval. Fixes without a date are not
+**	  saved, as the date is needed to aid the next start.
+*/
+bool GPSFixStore::update(const STORED_FIX* fix, uint32_t now, uint32_t interval)
+{
+	if (fix->DAY == 0 || (savedOnce && now - savedAt < interval)){
+		return false;
+	}
+	if (!save(fix)){
+		return false;
+	}
+	savedOnce = true;
+	savedAt = now;
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  getSlots(), getSequence()
+**
+**  Return Value:
+**    The number of slots, and the sequence number of the newest
+**	  saved fix, which counts the saves
+*/
+uint16_t GPSFixStore::getSlots()
+{
+	return slots;
+}
+
+uint16_t GPSFixStore::getSequence()
+{
+	return sequence;
+}
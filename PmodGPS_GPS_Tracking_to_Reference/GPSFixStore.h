@@ -0,0 +1,88 @@
+/************************************************************************/
+/*																		*/
+/*	GPSFixStore.h  Last good fix kept in EEPROM across restarts			*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Saves the position, UTC time and date of a fix to a ring of slots	*/
+/*	in EEPROM, each save going to the next slot so the writes are		*/
+/*	spread over the whole area. Reading back finds the newest slot		*/
+/*	with a good CRC, so a save cut short by a power loss leaves the	*/
+/*	one before it in use. The EEPROM is reached through STORE_READ and	*/
+/*	STORE_WRITE functions, so any EEPROM, FRAM or flash emulation can	*/
+/*	be used.															*/
+/*																		*/
+/*	Slot layout (little endian):										*/
+/*	  byte 0-1		sequence number, one more than the save before		*/
+/*	  byte 2-13		LAT, LON, ALT										*/
+/*	  byte 14-17	UTC													*/
+/*	  byte 18-20	DAY, MONTH, YEAR									*/
+/*	  byte 21		CRC-8 (polynomial 0x07, from 0xFF) of bytes 0-20	*/
+/*																		*/
+/*	The tracking sketch gives it the 320 bytes of the Uno's EEPROM		*/
+/*	before its track log, 14 slots, so saving every 5 minutes writes	*/
+/*	each slot every 70 minutes and 100 000 writes last 13 years.		*/
+/*																		*/
+/*	Does not depend on Arduino.h so it can also be built on a host		*/
+/*	computer.															*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSFixStore_H
+#define GPSFixStore_H
+
+#include <stdint.h>
+
+#define STORE_SLOT_SIZE  22		//Bytes per saved fix
+
+typedef struct STORED_FIX_T{
+	int32_t LAT;		//1e-7 degrees, as in FIX
+	int32_t LON;		//1e-7 degrees
+	int32_t ALT;		//cm
+	uint32_t UTC;		//ms since midnight
+	uint8_t DAY;		//UTC date, as in FIX
+	uint8_t MONTH;
+	uint8_t YEAR;		//Years since 2000
+}STORED_FIX;
+
+//Read or write size bytes at address, return false if it failed
+typedef bool (*STORE_READ)(void* context, uint16_t address, uint8_t* data, uint8_t size);
+typedef bool (*STORE_WRITE)(void* context, uint16_t address, const uint8_t* data, uint8_t size);
+
+uint8_t storeCRC8(const uint8_t* data, uint8_t size);
+
+class GPSFixStore
+{
+	public:
+	GPSFixStore();
+
+	uint16_t begin(STORE_READ read, STORE_WRITE write, void* context, uint16_t base, uint16_t size);
+	bool load(STORED_FIX* fix);
+	bool save(const STORED_FIX* fix);
+	bool update(const STORED_FIX* fix, uint32_t now, uint32_t interval);
+	uint16_t getSlots();
+	uint16_t getSequence();
+
+	private:
+	bool readSlot(uint16_t slot, uint8_t* data, uint16_t* sequence);
+
+	STORE_READ reader;
+	STORE_WRITE writer;
+	void* storeContext;
+	uint16_t baseAddress;	//Address of slot 0
+	uint16_t slots;			//Number of slots
+	uint16_t newest;		//Slot of the newest saved fix
+	uint16_t sequence;		//Its sequence number
+	bool found;				//A saved fix was found or has been saved
+	bool savedOnce;			//update() has saved since begin()
+	uint32_t savedAt;		//now passed to update() at its last save
+};
+
+#endif //GPSFixStore_H
@@ -0,0 +1,212 @@
+/************************************************************************/
+/*																		*/
+/*	GPSFormat.cpp  Text formatting of fix values without the heap		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include <string.h>
+#include "GPSFormat.h"
+
+static const uint32_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+/* ------------------------------------------------------------ */
+/*  Text helpers
+**
+**  Description:
+**    Each writes at p and returns the number of characters written.
+**	  The text is built in a FORMAT_MAX buffer on the stack and only
+**	  copied to the caller's buffer by finish(), once its length is
+**	  known.
+*/
+static uint8_t putDigits(char* p, uint32_t value, uint8_t minDigits)
+{
+	char reversed[10];
+	uint8_t count = 0;
+	uint8_t i;
+
+	do{
+		reversed[count++] = '0' + value % 10;
+		value /= 10;
+	}while (value);
+	while (count < minDigits){
+		reversed[count++] = '0';
+	}
+	for (i = 0; i < count; i++){
+		p[i] = reversed[count - 1 - i];
+	}
+	return count;
+}
+
+static uint8_t putFixed(char* p, bool negative, uint32_t magnitude, uint8_t decimals)
+{
+	uint8_t len = 0;
+
+	if (negative && magnitude){
+		p[len++] = '-';
+	}
+	len += putDigits(p + len, magnitude / powers[decimals], 1);
+	if (decimals){
+		p[len++] = '.';
+		len += putDigits(p + len, magnitude % powers[decimals], decimals);
+	}
+	return len;
+}
+
+static uint32_t magnitudeOf(int32_t value)
+{
+	return (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+}
+
+static char* finish(char* out, size_t n, const char* text, uint8_t len)
+{
+	if (n == 0){
+		return out;
+	}
+	if (len >= n){
+		len = 0;
+	}
+	memcpy(out, text, len);
+	out[len] = 0;
+	return out;
+}
+
+/* ------------------------------------------------------------ */
+/*  formatFixed()
+**
+**  Parameters:
+**	  out, n: the buffer and its size
+**	  value: the number times 10^decimals, such as FIX.ALT in cm
+**	  decimals: decimal places in value, 0 to 9
+**
+**  Return Value:
+**    out, such as "-12.34" for (-1234, 2)
+*/
+char* formatFixed(char* out, size_t n, int32_t value, uint8_t decimals)
+{
+	char text[FORMAT_MAX];
+
+	if (decimals > 9){
+		decimals = 9;
+	}
+	return finish(out, n, text, putFixed(text, value < 0, magnitudeOf(value), decimals));
+}
+
+/* ------------------------------------------------------------ */
+/*  formatDegrees()
+**
+**  Parameters:
+**	  out, n: the buffer and its size
+**	  degE7: latitude or longitude in 1e-7 degrees
+**	  decimals: decimal places to show, rounded, 0 to 7
+**
+**  Return Value:
+**    out, decimal degrees such as "-122.332100"
+*/
+char* formatDegrees(char* out, size_t n, int32_t degE7, uint8_t decimals)
+{
+	char text[FORMAT_MAX];
+	uint32_t divisor;
+
+	if (decimals > 7){
+		decimals = 7;
+	}
+	divisor = powers[7 - decimals];
+	return finish(out, n, text, putFixed(text, degE7 < 0, (magnitudeOf(degE7) + divisor / 2) / divisor, decimals));
+}
+
+/* ------------------------------------------------------------ */
+/*  formatDMS()
+**
+**  Parameters:
+**	  out, n: the buffer and its size
+**	  degE7: latitude or longitude in 1e-7 degrees
+**	  positive, negative: hemisphere letters, 'N' and 'S' or 'E' and
+**			'W'. With 0 the value is signed instead.
+**
+**  Return Value:
+**    out, degrees, minutes and seconds to 0.01" (about 30 cm), such
+**	  as 47°36'22.32"N
+*/
+char* formatDMS(char* out, size_t n, int32_t degE7, char positive, char negative)
+{
+	char text[FORMAT_MAX];
+	uint32_t magnitude = magnitudeOf(degE7);
+	uint32_t degrees = magnitude / 10000000UL;
+	uint32_t hundredths = ((magnitude % 10000000UL) * 36 + 500) / 1000;	//0.01" in the part degree, 1e-7 degree is 0.00036"
+	uint8_t len = 0;
+
+	if (hundredths >= 360000UL){//Rounded up to a whole degree
+		hundredths -= 360000UL;
+		degrees++;
+	}
+	if (positive == 0 && degE7 < 0){
+		text[len++] = '-';
+	}
+	len += putDigits(text + len, degrees, 1);
+	text[len++] = FORMAT_DEGREE_SIGN;
+	len += putDigits(text + len, hundredths / 6000, 2);
+	text[len++] = '\'';
+	len += putDigits(text + len, hundredths % 6000 / 100, 2);
+	text[len++] = '.';
+	len += putDigits(text + len, hundredths % 100, 2);
+	text[len++] = '"';
+	if (positive){
+		text[len++] = (degE7 < 0) ? negative : positive;
+	}
+	return finish(out, n, text, len);
+}
+
+/* ------------------------------------------------------------ */
+/*  formatAltitude(), formatTime(), formatDate()
+**
+**  Parameters:
+**	  out, n: the buffer and its size
+**	  cm: altitude from FIX.ALT
+**	  utc: time from FIX.UTC, ms since midnight
+**	  day, month, year: date from FIX.DAY, FIX.MONTH and FIX.YEAR
+**
+**  Return Value:
+**    out, such as "39.90 m", "06:49:51" and "04/26/06"
+*/
+char* formatAltitude(char* out, size_t n, int32_t cm)
+{
+	char text[FORMAT_MAX];
+	uint8_t len = putFixed(text, cm < 0, magnitudeOf(cm), 2);
+
+	text[len++] = ' ';
+	text[len++] = 'm';
+	return finish(out, n, text, len);
+}
+
+char* formatTime(char* out, size_t n, uint32_t utc)
+{
+	char text[FORMAT_MAX];
+	uint32_t seconds = utc / 1000 % 86400UL;
+	uint8_t len = 0;
+
+	len += putDigits(text + len, seconds / 3600, 2);
+	text[len++] = ':';
+	len += putDigits(text + len, seconds / 60 % 60, 2);
+	text[len++] = ':';
+	len += putDigits(text + len, seconds % 60, 2);
+	return finish(out, n, text, len);
+}
+
+char* formatDate(char* out, size_t n, uint8_t day, uint8_t month, uint8_t year)
+{
+	char text[FORMAT_MAX];
+	uint8_t len = 0;
+
+	len += putDigits(text + len, month, 2);
+	text[len++] = '/';
+	len += putDigits(text + len, day, 2);
+	text[len++] = '/';
+	len += putDigits(text + len, year % 100, 2);
+	return finish(out, n, text, len);
+}
@@ -0,0 +1,46 @@
+/************************************************************************/
+/*																		*/
+/*	GPSFormat.h  Text formatting of fix values without the heap		*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Writes coordinates, altitude, time and date from the integer FIX	*/
+/*	values into a buffer the caller owns, with integer arithmetic only.	*/
+/*	No String, sprintf or dtostrf, so nothing is allocated and the		*/
+/*	float printing code is not linked in. Each function returns out,	*/
+/*	so the result can be passed straight to print(). If the text does	*/
+/*	not fit in n bytes, including the terminating null, out is set to	*/
+/*	an empty string.													*/
+/*																		*/
+/*	Does not depend on Arduino.h so it can also be built on a host		*/
+/*	computer.															*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSFormat_H
+#define GPSFormat_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FORMAT_DEGREE_SIGN
+#define FORMAT_DEGREE_SIGN  ((char)0xDF)	//Degree sign in the HD44780 character set of the Pmod CLS, 0xB0 in Latin-1
+#endif
+
+#define FORMAT_MAX  24	//Longest text any of the functions writes, with its null
+
+char* formatFixed(char* out, size_t n, int32_t value, uint8_t decimals);
+char* formatDegrees(char* out, size_t n, int32_t degE7, uint8_t decimals);
+char* formatDMS(char* out, size_t n, int32_t degE7, char positive, char negative);
+char* formatAltitude(char* out, size_t n, int32_t cm);
+char* formatTime(char* out, size_t n, uint32_t utc);
+char* formatDate(char* out, size_t n, uint8_t day, uint8_t month, uint8_t year);
+
+#endif //GPSFormat_H
@@ -0,0 +1,362 @@
+/************************************************************************/
+/*																		*/
+/*	GPSGeofence.cpp  Circle and polygon geofences on the fix stream		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include <math.h>
+#include <string.h>
+#include "GPSGeofence.h"
+
+GPSGeofence::GPSGeofence()
+{
+	begin(NULL, 0, 0, 0);
+}
+
+/* ------------------------------------------------------------ */
+/*  begin()
+**
+**  Parameters:
+**	  fenceArray: storage for the fences
+**	  size: number of GEOFENCEs in fenceArray
+**	  originLat, originLon: point the tangent plane touches, in 1e-7
+**			degrees, normally the middle of the fenced area
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Removes any fences and sets the hysteresis and dwell time back
+**	  to FENCE_HYSTERESIS and FENCE_DWELL_MS.
+*/
+void GPSGeofence::begin(GEOFENCE* fenceArray, uint16_t size, int32_t originLat, int32_t originLon)
+{
+	geoSetReference(&origin, originLat, originLon);
+	fences = fenceArray;
+	capacity = fenceArray ? size : 0;
+	count = 0;
+	hysteresis = FENCE_HYSTERESIS;
+	dwell = FENCE_DWELL_MS;
+	onEvent = NULL;
+	fullTests = 0;
+}
+
+/* ------------------------------------------------------------ */
+/*  addCircle()
+**
+**  Parameters:
+**	  latE7, lonE7: centre in 1e-7 degrees
+**	  radius: metres
+**
+**  Return Value:
+**    the fence's number, FENCE_NONE if the array is full
+*/
+uint16_t GPSGeofence::addCircle(int32_t latE7, int32_t lonE7, float radius)
+{
+	GEOFENCE* fence;
+
+	if (count >= capacity){
+		return FENCE_NONE;
+	}
+	fence = &fences[count];
+	memset(fence, 0, sizeof(GEOFENCE));
+	fence->TYPE = FENCE_CIRCLE;
+	fence->STATE = FENCE_UNKNOWN;
+	fence->RADIUS = radius;
+	geoOffset(&origin, latE7, lonE7, &fence->CENTER.E, &fence->CENTER.N);
+	fence->MINE = fence->CENTER.E - radius;
+	fence->MAXE = fence->CENTER.E + radius;
+	fence->MINN = fence->CENTER.N - radius;
+	fence->MAXN = fence->CENTER.N + radius;
+	return count++;
+}
+
+/* ------------------------------------------------------------ */
+/*  addPolygon()
+**
+**  Parameters:
+**	  read: function that reads one vertex, see GPSWaypoints.h
+**	  source: passed to read, normally the address of the vertices
+**	  vertices: number of vertices, at least 3
+**	  points: storage for the vertices on the tangent plane, kept
+**			for as long as the fence is used
+**
+**  Return Value:
+**    the fence's number, FENCE_NONE if the array is full or there
+**	  are too few vertices
+**
+**  Description:
+**    The vertices can be kept in PROGMEM, RAM or EEPROM like
+**	  waypoints. They are listed in order around the polygon, either
+**	  way round, without repeating the first one at the end. The
+**	  polygon may be concave.
+*/
+uint16_t GPSGeofence::addPolygon(WAYPOINT_READ read, const void* source, uint16_t vertices, GEO_POINT* points)
+{
+	GEOFENCE* fence;
+	WAYPOINT wp;
+	uint16_t i;
+
+	if (count >= capacity || vertices < 3){
+		return FENCE_NONE;
+	}
+	fence = &fences[count];
+	memset(fence, 0, sizeof(GEOFENCE));
+	fence->TYPE = FENCE_POLYGON;
+	fence->STATE = FENCE_UNKNOWN;
+	fence->POINTS = points;
+	fence->COUNT = vertices;
+	for (i = 0; i < vertices; i++){
+		read(source, i, &wp);
+		geoOffset(&origin, wp.LAT, wp.LON, &points[i].E, &points[i].N);
+		if (i == 0 || points[i].E < fence->MINE){
+			fence->MINE = points[i].E;
+		}
+		if (i == 0 || points[i].E > fence->MAXE){
+			fence->MAXE = points[i].E;
+		}
+		if (i == 0 || points[i].N < fence->MINN){
+			fence->MINN = points[i].N;
+		}
+		if (i == 0 || points[i].N > fence->MAXN){
+			fence->MAXN = points[i].N;
+		}
+	}
+	return count++;
+}
+
+/* ------------------------------------------------------------ */
+/*  setHysteresis(), setDwell(), setCallback()
+**
+**  Parameters:
+**	  metres: how far past a boundary the unit has to be before the
+**			fence is entered or left
+**	  ms: how long the unit has to stay in a fence for FENCE_DWELL
+**	  callback: called by update() for each event, NULL for none
+*/
+void GPSGeofence::setHysteresis(float metres)
+{
+	hysteresis = metres;
+}
+
+void GPSGeofence::setDwell(uint32_t ms)
+{
+	dwell = ms;
+}
+
+void GPSGeofence::setCallback(FENCE_CALLBACK callback)
+{
+	onEvent = callback;
+}
+
+/* ------------------------------------------------------------ */
+/*  update()
+**
+**  Parameters:
+**	  latE7, lonE7: the fix, in 1e-7 degrees
+**	  ms: time of the fix in ms, from millis() or FIX.UTC, used for
+**			the dwell time
+**
+**  Return Value:
+**    the number of events raised
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Tests the fix against every fence in the steps described in
+**	  GPSGeofence.h. The first fix sets the state of each fence, with
+**	  FENCE_ENTER for the ones it is in.
+*/
+uint16_t GPSGeofence::update(int32_t latE7, int32_t lonE7, uint32_t ms)
+{
+	GEO_POINT p;
+	GEOFENCE* fence;
+	uint16_t events = 0;
+	uint16_t i;
+	float dE, dN, d;
+	uint8_t state, previous;
+
+	geoOffset(&origin, latE7, lonE7, &p.E, &p.N);
+
+	for (i = 0; i < count; i++){
+		fence = &fences[i];
+		state = previous = fence->STATE;
+
+		dE = p.E - fence->LAST.E;
+		dN = p.N - fence->LAST.N;
+		if (state == FENCE_UNKNOWN || dE * dE + dN * dN >= fence->MARGIN * fence->MARGIN){
+			d = -boxDistance(fence, p);
+			if (d == 0 || (state == FENCE_INSIDE && d >= -hysteresis)){
+				fullTests++;
+				d = boundaryDistance(fence, p);	//Signed, positive inside
+			}
+
+			if (state == FENCE_UNKNOWN){
+				state = (d >= 0) ? FENCE_INSIDE : FENCE_OUTSIDE;
+			}
+			else if (state == FENCE_INSIDE && d < -hysteresis){
+				state = FENCE_OUTSIDE;
+			}
+			else if (state == FENCE_OUTSIDE && d > hysteresis){
+				state = FENCE_INSIDE;
+			}
+			fence->MARGIN = (state == FENCE_INSIDE) ? d + hysteresis : hysteresis - d;
+			fence->LAST = p;
+
+			fence->STATE = state;
+			if (state == FENCE_INSIDE && previous != FENCE_INSIDE){
+				fence->ENTERED = ms;
+				fence->DWELLED = false;
+				events += raise(i, FENCE_ENTER);
+			}
+			else if (state == FENCE_OUTSIDE && previous == FENCE_INSIDE){
+				events += raise(i, FENCE_EXIT);
+			}
+		}
+
+		if (state == FENCE_INSIDE && !fence->DWELLED && ms - fence->ENTERED >= dwell){
+			fence->DWELLED = true;
+			events += raise(i, FENCE_DWELL);
+		}
+	}
+	return events;
+}
+
+/* ------------------------------------------------------------ */
+/*  getState(), getCount(), getFullTests()
+**
+**  Return Value:
+**    the state of a fence, the number of fences, and how many fence
+**	  tests since begin() needed the full test
+*/
+FENCE_STATE GPSGeofence::getState(uint16_t fence)
+{
+	return (fence < count) ? (FENCE_STATE)fences[fence].STATE : FENCE_UNKNOWN;
+}
+
+uint16_t GPSGeofence::getCount()
+{
+	return count;
+}
+
+uint32_t GPSGeofence::getFullTests()
+{
+	return fullTests;
+}
+
+/* ------------------------------------------------------------ */
+/*					Private Functions							*/
+
+/* ------------------------------------------------------------ */
+/*  boxDistance()
+**
+**  Return Value:
+**    distance from p to the fence's bounding box, 0 inside it
+*/
+float GPSGeofence::boxDistance(const GEOFENCE* fence, GEO_POINT p)
+{
+	float dE = 0, dN = 0;
+
+	if (p.E < fence->MINE){
+		dE = fence->MINE - p.E;
+	}
+	else if (p.E > fence->MAXE){
+		dE = p.E - fence->MAXE;
+	}
+	if (p.N < fence->MINN){
+		dN = fence->MINN - p.N;
+	}
+	else if (p.N > fence->MAXN){
+		dN = p.N - fence->MAXN;
+	}
+	if (dE == 0 || dN == 0){//Beside the box, no square root needed
+		return dE + dN;
+	}
+	return sqrtf(dE * dE + dN * dN);
+}
+
+/* ------------------------------------------------------------ */
+/*  boundaryDistance()
+**
+**  Return Value:
+**    distance from p to the fence's boundary, positive inside
+*/
+float GPSGeofence::boundaryDistance(const GEOFENCE* fence, GEO_POINT p)
+{
+	float dE, dN;
+
+	if (fence->TYPE == FENCE_CIRCLE){
+		dE = p.E - fence->CENTER.E;
+		dN = p.N - fence->CENTER.N;
+		return fence->RADIUS - sqrtf(dE * dE + dN * dN);
+	}
+	return polygonDistance(fence, p);
+}
+
+/* ------------------------------------------------------------ */
+/*  polygonDistance()
+**
+**  Return Value:
+**    distance from p to the nearest edge, positive inside
+**
+**  Description:
+**    One pass over the edges counts the crossings of a ray going
+**	  east from p, odd means inside, and finds the nearest edge.
+*/
+float GPSGeofence::polygonDistance(const GEOFENCE* fence, GEO_POINT p)
+{
+	const GEO_POINT* a = &fence->POINTS[fence->COUNT - 1];
+	const GEO_POINT* b;
+	float best = INFINITY;
+	float eE, eN, pE, pN, t, dE, dN, d2, len2;
+	bool inside = false;
+	uint16_t i;
+
+	for (i = 0; i < fence->COUNT; i++, a = b){
+		b = &fence->POINTS[i];
+		eE = b->E - a->E;
+		eN = b->N - a->N;
+		pE = p.E - a->E;
+		pN = p.N - a->N;
+
+		if ((a->N > p.N) != (b->N > p.N) && pE < eE * pN / eN){
+			inside = !inside;
+		}
+
+		len2 = eE * eE + eN * eN;
+		t = (len2 > 0) ? (pE * eE + pN * eN) / len2 : 0;
+		t = (t < 0) ? 0 : ((t > 1) ? 1 : t);
+		dE = pE - t * eE;
+		dN = pN - t * eN;
+		d2 = dE * dE + dN * dN;
+		if (d2 < best){
+			best = d2;
+		}
+	}
+	best = sqrtf(best);
+	return inside ? best : -best;
+}
+
+/* ------------------------------------------------------------ */
+/*  raise()
+**
+**  Return Value:
+**    1, the number of events raised
+*/
+uint16_t GPSGeofence::raise(uint16_t index, FENCE_EVENT event)
+{
+	if (onEvent){
+		onEvent(index, event);
+	}
+	return 1;
+}
@@ -0,0 +1,120 @@
+/************************************************************************/
+/*																		*/
+/*	GPSGeofence.h  Circle and polygon geofences on the fix stream		*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Tracks which of a set of geofences the unit is in and reports		*/
+/*	enter, exit and dwell events. Fences and fixes are turned into		*/
+/*	metres on the plane tangent at an origin given to begin(), so the	*/
+/*	fences should lie within a few tens of km of it.					*/
+/*																		*/
+/*	For each fix a fence is tested in steps, stopping at the first		*/
+/*	that settles it:													*/
+/*	  1. if the unit has moved less than the fence's boundary was		*/
+/*		 away at its last full test, its state can not have changed		*/
+/*	  2. outside the bounding box, the distance to the box is enough	*/
+/*	  3. a full test: distance to the circle, or crossing number and	*/
+/*		 distance to the nearest edge of the polygon					*/
+/*	A fence is only entered once the unit is the hysteresis distance	*/
+/*	inside it and only left once it is that far outside, so noise near	*/
+/*	a boundary does not make it flap.									*/
+/*																		*/
+/*	The caller provides the GEOFENCE array and the vertex storage of	*/
+/*	polygons, nothing is allocated. Does not depend on Arduino.h so it	*/
+/*	can also be built on a host computer.								*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSGeofence_H
+#define GPSGeofence_H
+
+#include <stdint.h>
+#include "GPSgeo.h"
+#include "GPSWaypoints.h"
+
+#define FENCE_HYSTERESIS	10.0f	//Default metres past a boundary before it counts
+#define FENCE_DWELL_MS		60000	//Default ms inside a fence before FENCE_DWELL
+#define FENCE_NONE			0xFFFF	//Returned by the add functions when the array is full
+
+typedef enum{
+	FENCE_CIRCLE,
+	FENCE_POLYGON
+}FENCE_TYPE;
+
+typedef enum{
+	FENCE_UNKNOWN,	//No fix tested yet
+	FENCE_OUTSIDE,
+	FENCE_INSIDE
+}FENCE_STATE;
+
+typedef enum{
+	FENCE_ENTER,
+	FENCE_EXIT,
+	FENCE_DWELL		//Inside for the dwell time, once per entry
+}FENCE_EVENT;
+
+//A position on the tangent plane, metres east and north of the origin
+typedef struct GEO_POINT_T{
+	float E;
+	float N;
+}GEO_POINT;
+
+typedef struct GEOFENCE_T{
+	GEO_POINT* POINTS;	//Polygon vertices
+	GEO_POINT CENTER;	//Circle centre
+	GEO_POINT LAST;		//Position MARGIN was worked out at
+	float RADIUS;		//Circle radius, metres
+	float MARGIN;		//Distance the unit can move from LAST before the state may change
+	float MINE, MINN;	//Bounding box
+	float MAXE, MAXN;
+	uint32_t ENTERED;	//Time the fence was entered, ms
+	uint16_t COUNT;		//Polygon vertices
+	uint8_t TYPE;		//FENCE_TYPE
+	uint8_t STATE;		//FENCE_STATE
+	bool DWELLED;		//FENCE_DWELL sent since entering
+}GEOFENCE;
+
+typedef void (*FENCE_CALLBACK)(uint16_t fence, FENCE_EVENT event);
+
+class GPSGeofence
+{
+	public:
+	GPSGeofence();
+
+	void begin(GEOFENCE* fenceArray, uint16_t size, int32_t originLat, int32_t originLon);
+	uint16_t addCircle(int32_t latE7, int32_t lonE7, float radius);
+	uint16_t addPolygon(WAYPOINT_READ read, const void* source, uint16_t count, GEO_POINT* points);
+	void setHysteresis(float metres);
+	void setDwell(uint32_t ms);
+	void setCallback(FENCE_CALLBACK callback);
+
+	uint16_t update(int32_t latE7, int32_t lonE7, uint32_t ms);
+	FENCE_STATE getState(uint16_t fence);
+	uint16_t getCount();
+	uint32_t getFullTests();
+
+	private:
+	float boundaryDistance(const GEOFENCE* fence, GEO_POINT p);
+	float polygonDistance(const GEOFENCE* fence, GEO_POINT p);
+	float boxDistance(const GEOFENCE* fence, GEO_POINT p);
+	uint16_t raise(uint16_t index, FENCE_EVENT event);
+
+	GEO_REF origin;
+	GEOFENCE* fences;
+	uint16_t capacity;
+	uint16_t count;
+	float hysteresis;
+	uint32_t dwell;
+	FENCE_CALLBACK onEvent;
+	uint32_t fullTests;		//Fences that needed step 3, for tuning
+};
+
+#endif //GPSGeofence_H
@@ -0,0 +1,149 @@
+/************************************************************************/
+/*																		*/
+/*	GPSRingBuffer.h  Receive byte ring for the PmodGPS library			*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Lock-free single producer / single consumer byte ring. The producer	*/
+/*	(a receive ISR, serialEvent() or yield()) only writes head, the		*/
+/*	consumer (the sentence parser) only writes tail, so neither needs	*/
+/*	to disable interrupts. The indices are single bytes so reads and	*/
+/*	writes of them are atomic on AVR.									*/
+/*																		*/
+/*	GPS_RX_BUFFER_SIZE may be defined before this file is included to	*/
+/*	change the size. It must be a power of two no larger than 256, one	*/
+/*	byte of it is kept free to tell a full ring from an empty one.		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSRingBuffer_H
+#define GPSRingBuffer_H
+
+#include <stdint.h>
+
+#ifndef GPS_RX_BUFFER_SIZE
+#define GPS_RX_BUFFER_SIZE  128
+#endif
+
+#if (GPS_RX_BUFFER_SIZE & (GPS_RX_BUFFER_SIZE - 1)) || GPS_RX_BUFFER_SIZE > 256
+#error "GPS_RX_BUFFER_SIZE must be a power of two no larger than 256"
+#endif
+
+#define GPS_RX_BUFFER_MASK  (GPS_RX_BUFFER_SIZE - 1)
+
+typedef struct RING_STATS_T{
+	uint8_t highWater;		//Most bytes held in the ring at once
+	uint16_t dropped;			//Bytes lost because the ring was full
+	uint16_t uartOverruns;	//Times the serial port reported its own buffer overran
+}RING_STATS;
+
+class GPSRingBuffer
+{
+	public:
+	GPSRingBuffer()
+	{
+		clear();
+	}
+
+	/* ------------------------------------------------------------ */
+	/*  push()
+	**
+	**  Description:
+	**    Producer side, safe to call from an ISR. Returns false and
+	**		counts the byte as dropped if the ring is full.
+	*/
+	bool push(uint8_t c)
+	{
+		uint8_t next = (head + 1) & GPS_RX_BUFFER_MASK;
+		uint8_t used;
+
+		if (next == tail){
+			if (dropped != 0xFFFF){
+				dropped++;
+			}
+			return false;
+		}
+		buffer[head] = c;
+		head = next;
+		used = (next - tail) & GPS_RX_BUFFER_MASK;
+		if (used > highWater){
+			highWater = used;
+		}
+		return true;
+	}
+
+	/* ------------------------------------------------------------ */
+	/*  pop()
+	**
+	**  Description:
+	**    Consumer side. Returns -1 if the ring is empty.
+	*/
+	int pop()
+	{
+		uint8_t c;
+
+		if (head == tail){
+			return -1;
+		}
+		c = buffer[tail];
+		tail = (tail + 1) & GPS_RX_BUFFER_MASK;
+		return c;
+	}
+
+	uint8_t available()
+	{
+		return (head - tail) & GPS_RX_BUFFER_MASK;
+	}
+
+	bool isFull()
+	{
+		return ((head + 1) & GPS_RX_BUFFER_MASK) == tail;
+	}
+
+	//Index the next push() writes to, producer side
+	uint8_t getHead()
+	{
+		return head;
+	}
+
+	//Index the next pop() reads from, consumer side
+	uint8_t getTail()
+	{
+		return tail;
+	}
+
+	//Only while nothing is pushing bytes
+	void clear()
+	{
+		head = 0;
+		tail = 0;
+		highWater = 0;
+		dropped = 0;
+	}
+
+	uint8_t getHighWater()
+	{
+		return highWater;
+	}
+
+	uint16_t getDropped()
+	{
+		return dropped;
+	}
+
+	private:
+	uint8_t buffer[GPS_RX_BUFFER_SIZE];
+	volatile uint8_t head;		//Next slot written, producer only
+	volatile uint8_t tail;		//Next slot read, consumer only
+	volatile uint8_t highWater;
+	volatile uint16_t dropped;
+};
+
+#endif //GPSRingBuffer_H
@@ -0,0 +1,280 @@
+/************************************************************************/
+/*																		*/
+/*	GPSTrackLog.cpp  Compact binary track log							*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include <string.h>
+#include "GPSTrackLog.h"
+
+//Values with a second order prediction (last + step), the rest use last
+#define SECOND_ORDER(v)  ((v) < 3)
+
+/* ------------------------------------------------------------ */
+/*  Coder helpers
+**
+**  Description:
+**    All arithmetic is done on uint32_t so it wraps the same way in
+**	  the encoder and decoder, a longitude jump across the
+**	  antimeridian or a time across midnight still round trips.
+*/
+static void pointValues(const TRACK_POINT* point, uint32_t* v)
+{
+	v[0] = (uint32_t)point->LAT;
+	v[1] = (uint32_t)point->LON;
+	v[2] = point->UTC;
+	v[3] = (uint32_t)point->ALT;
+	v[4] = point->SPEED;
+}
+
+static uint32_t predict(const TRACK_CODER* coder, uint8_t v)
+{
+	return SECOND_ORDER(v) ? coder->LAST[v] + coder->STEP[v] : coder->LAST[v];
+}
+
+static void commit(TRACK_CODER* coder, const uint32_t* v)
+{
+	uint8_t i;
+
+	for (i = 0; i < TRACK_VALUES; i++){
+		coder->STEP[i] = coder->STARTED ? v[i] - coder->LAST[i] : 0;	//No step from the zeros before the first point
+		coder->LAST[i] = v[i];
+	}
+	coder->STARTED = true;
+}
+
+static uint8_t putVarint(uint8_t* out, uint32_t residual)
+{
+	uint32_t zigzag = (residual << 1) ^ (uint32_t)((int32_t)residual >> 31);
+	uint8_t n = 0;
+
+	while (zigzag >= 0x80){
+		out[n++] = (uint8_t)zigzag | 0x80;
+		zigzag >>= 7;
+	}
+	out[n++] = (uint8_t)zigzag;
+	return n;
+}
+
+static int8_t getVarint(const uint8_t* in, uint16_t size, uint32_t* residual)
+{
+	uint32_t zigzag = 0;
+	uint8_t n = 0;
+
+	do{
+		if (n >= size || n >= 5){
+			return -1;
+		}
+		zigzag |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+	}while (in[n++] & 0x80);
+	*residual = (zigzag >> 1) ^ (0 - (zigzag & 1));
+	return n;
+}
+
+/* ------------------------------------------------------------ */
+/*  trackDecodeBlock()
+**
+**  Parameters:
+**	  block: a block written by GPSTrackLog
+**	  size: TRACK_BLOCK_SIZE of the log that wrote it
+**	  read: called with each point in the block, in order
+**	  context: passed to read
+**	  sequence: set to the block's sequence number, may be NULL
+**
+**  Return Value:
+**    the number of points decoded, -1 if the block is not a track
+**	  block (erased or never written)
+**
+**  Errors:
+**    Returns the points decoded so far if the block ends part way
+**	  through a point
+*/
+int16_t trackDecodeBlock(const uint8_t* block, uint16_t size, TRACK_POINT_READ read, void* context, uint16_t* sequence)
+{
+	TRACK_CODER coder;
+	TRACK_POINT point;
+	uint32_t v[TRACK_VALUES];
+	uint32_t residual;
+	uint16_t pos = TRACK_HEADER_SIZE;
+	int16_t decoded;
+	int8_t n;
+	uint8_t i;
+
+	if (size < TRACK_HEADER_SIZE || block[0] != TRACK_MAGIC){
+		return -1;
+	}
+	if (sequence){
+		*sequence = block[2] | (uint16_t)block[3] << 8;
+	}
+	memset(&coder, 0, sizeof(coder));
+	for (decoded = 0; decoded < block[1]; decoded++){
+		for (i = 0; i < TRACK_VALUES; i++){
+			n = getVarint(block + pos, size - pos, &residual);
+			if (n < 0){
+				return decoded;
+			}
+			pos += n;
+			v[i] = predict(&coder, i) + residual;
+		}
+		commit(&coder, v);
+		point.LAT = (int32_t)v[0];
+		point.LON = (int32_t)v[1];
+		point.UTC = v[2];
+		point.ALT = (int32_t)v[3];
+		point.SPEED = v[4];
+		read(context, &point);
+	}
+	return decoded;
+}
+
+GPSTrackLog::GPSTrackLog()
+{
+	begin(NULL, NULL);
+}
+
+/* ------------------------------------------------------------ */
+/*  begin()
+**
+**  Parameters:
+**	  write: called with each full block
+**	  context: passed to write, for example the file or address
+**	  firstSequence: sequence number of the first block, so a log
+**			can carry on from the blocks already stored
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+*/
+void GPSTrackLog::begin(TRACK_WRITE write, void* context, uint16_t firstSequence)
+{
+	writer = write;
+	writeContext = context;
+	sequence = firstSequence;
+	points = 0;
+	blocks = 0;
+	failed = 0;
+	startBlock();
+}
+
+/* ------------------------------------------------------------ */
+/*  append()
+**
+**  Parameters:
+**	  point: the fix to log
+**
+**  Return Value:
+**    false if a full block had to be written and could not be
+**
+**  Errors:
+**    The point is kept, in a new block, even when the full block
+**	  could not be written
+**
+**  Description:
+**    Encodes the point at the end of the block. If it does not fit
+**	  the block is written and the point starts the next one.
+*/
+bool GPSTrackLog::append(const TRACK_POINT* point)
+{
+	uint8_t encoded[TRACK_POINT_MAX];
+	uint32_t v[TRACK_VALUES];
+	uint8_t length;
+	uint8_t i;
+	bool written = true;
+
+	pointValues(point, v);
+	do{
+		length = 0;
+		for (i = 0; i < TRACK_VALUES; i++){
+			length += putVarint(encoded + length, v[i] - predict(&coder, i));
+		}
+		if (used + length <= TRACK_BLOCK_SIZE && block[1] < 255){
+			break;
+		}
+		written = writeBlock();//Full, the point is encoded again from zero
+	}while (true);
+
+	memcpy(block + used, encoded, length);
+	used += length;
+	block[1]++;
+	commit(&coder, v);
+	points++;
+	return written;
+}
+
+/* ------------------------------------------------------------ */
+/*  flush()
+**
+**  Return Value:
+**    false if the block could not be written
+**
+**  Description:
+**    Writes the block being filled, if it has any points, so the log
+**	  is complete up to now. The next point starts a new block, so
+**	  flushing often wastes space.
+*/
+bool GPSTrackLog::flush()
+{
+	if (block[1] == 0){
+		return true;
+	}
+	return writeBlock();
+}
+
+/* ------------------------------------------------------------ */
+/*  getPoints(), getBlocks(), getFailed()
+**
+**  Return Value:
+**    points appended, blocks written and blocks that failed to be
+**	  written since begin()
+*/
+uint32_t GPSTrackLog::getPoints()
+{
+	return points;
+}
+
+uint32_t GPSTrackLog::getBlocks()
+{
+	return blocks;
+}
+
+uint16_t GPSTrackLog::getFailed()
+{
+	return failed;
+}
+
+/* ------------------------------------------------------------ */
+/*					Private Functions							*/
+
+void GPSTrackLog::startBlock()
+{
+	memset(block, 0xFF, sizeof(block));
+	block[0] = TRACK_MAGIC;
+	block[1] = 0;
+	block[2] = (uint8_t)sequence;
+	block[3] = (uint8_t)(sequence >> 8);
+	used = TRACK_HEADER_SIZE;
+	memset(&coder, 0, sizeof(coder));
+}
+
+bool GPSTrackLog::writeBlock()
+{
+	bool written = writer && writer(writeContext, block, TRACK_BLOCK_SIZE);
+
+	if (written){
+		blocks++;
+	}
+	else if (failed != 0xFFFF){
+		failed++;
+	}
+	sequence++;
+	startBlock();
+	return written;
+}
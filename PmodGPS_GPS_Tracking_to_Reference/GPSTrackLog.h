@@ -0,0 +1,106 @@
+/************************************************************************/
+/*																		*/
+/*	GPSTrackLog.h  Compact binary track log								*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Records fixes as variable length deltas in fixed size blocks and	*/
+/*	hands each full block to a TRACK_WRITE function, which can write	*/
+/*	it to an SD card, EEPROM or, on a host computer, a file.			*/
+/*																		*/
+/*	Block layout (little endian):										*/
+/*	  byte 0	TRACK_MAGIC												*/
+/*	  byte 1	number of points in the block							*/
+/*	  byte 2-3	block sequence number, to order blocks from a ring		*/
+/*	  byte 4-	points, unused bytes are 0xFF							*/
+/*																		*/
+/*	Each point is five zigzag varints: latitude, longitude, UTC time,	*/
+/*	altitude and speed. Latitude, longitude and time are stored as the	*/
+/*	change from the step between the two points before, so a steady	*/
+/*	track costs one byte each. Altitude and speed are stored as the		*/
+/*	change from the point before. The coder starts from zero in every	*/
+/*	block, so the first point is stored in full and each block can be	*/
+/*	decoded on its own. A 1 Hz drive takes about 6 bytes a fix in 512	*/
+/*	byte blocks, 9 in 64 byte blocks.									*/
+/*																		*/
+/*	TRACK_BLOCK_SIZE may be defined before this file is included, for	*/
+/*	example 512 to match SD card sectors. Does not depend on Arduino.h	*/
+/*	so it can also be built on a host computer.							*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSTrackLog_H
+#define GPSTrackLog_H
+
+#include <stdint.h>
+
+#ifndef TRACK_BLOCK_SIZE
+#define TRACK_BLOCK_SIZE  64
+#endif
+
+#if TRACK_BLOCK_SIZE < 32 || TRACK_BLOCK_SIZE > 4096
+#error "TRACK_BLOCK_SIZE must be from 32 to 4096"
+#endif
+
+#define TRACK_MAGIC			0x54	//'T'
+#define TRACK_HEADER_SIZE	4
+#define TRACK_VALUES		5		//Values per point
+#define TRACK_POINT_MAX		(TRACK_VALUES * 5)	//Longest encoded point, bytes
+
+typedef struct TRACK_POINT_T{
+	int32_t LAT;		//1e-7 degrees, as in FIX
+	int32_t LON;		//1e-7 degrees
+	uint32_t UTC;		//ms since midnight
+	int32_t ALT;		//cm
+	uint32_t SPEED;		//mm/s
+}TRACK_POINT;
+
+//Previous values and steps, shared by the encoder and decoder
+typedef struct TRACK_CODER_T{
+	uint32_t LAST[TRACK_VALUES];
+	uint32_t STEP[TRACK_VALUES];
+	bool STARTED;		//A point has been coded in this block
+}TRACK_CODER;
+
+//Writes one block, returns false if it could not be written
+typedef bool (*TRACK_WRITE)(void* context, const uint8_t* block, uint16_t size);
+//Receives each point decoded by trackDecodeBlock()
+typedef void (*TRACK_POINT_READ)(void* context, const TRACK_POINT* point);
+
+int16_t trackDecodeBlock(const uint8_t* block, uint16_t size, TRACK_POINT_READ read, void* context, uint16_t* sequence);
+
+class GPSTrackLog
+{
+	public:
+	GPSTrackLog();
+
+	void begin(TRACK_WRITE write, void* context, uint16_t firstSequence = 0);
+	bool append(const TRACK_POINT* point);
+	bool flush();
+	uint32_t getPoints();
+	uint32_t getBlocks();
+	uint16_t getFailed();
+
+	private:
+	void startBlock();
+	bool writeBlock();
+
+	TRACK_WRITE writer;
+	void* writeContext;
+	TRACK_CODER coder;
+	uint8_t block[TRACK_BLOCK_SIZE];
+	uint16_t used;			//Bytes of block filled
+	uint16_t sequence;		//Sequence number of the block being filled
+	uint32_t points;		//Points appended since begin()
+	uint32_t blocks;		//Blocks written since begin()
+	uint16_t failed;		//Blocks the writer could not write
+};
+
+#endif //GPSTrackLog_H
@@ -0,0 +1,259 @@
+/************************************************************************/
+/*																		*/
+/*	GPSWaypoints.cpp  Stored waypoints and nearest waypoint queries		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include <math.h>
+#include <string.h>
+#include "GPSWaypoints.h"
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#define memcpy_P memcpy
+#endif
+
+/* ------------------------------------------------------------ */
+/*  waypointReadProgmem(), waypointReadRam()
+**
+**  Parameters:
+**	  source: the WAYPOINT array
+**	  index: the waypoint to read
+**	  wp: set to the waypoint
+**
+**  Description:
+**    WAYPOINT_READ functions for tables in program memory and RAM.
+*/
+void waypointReadProgmem(const void* source, uint16_t index, WAYPOINT* wp)
+{
+	memcpy_P(wp, (const WAYPOINT*)source + index, sizeof(WAYPOINT));
+}
+
+void waypointReadRam(const void* source, uint16_t index, WAYPOINT* wp)
+{
+	*wp = ((const WAYPOINT*)source)[index];
+}
+
+GPSWaypoints::GPSWaypoints()
+{
+	begin(NULL, NULL, 0);
+}
+
+/* ------------------------------------------------------------ */
+/*  begin()
+**
+**  Parameters:
+**	  read: function that reads one waypoint from the table
+**	  source: passed to read, normally the address of the table
+**	  count: number of waypoints in the table
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    The table is not copied. It must stay sorted by latitude, which
+**	  isSorted() can be used to check.
+*/
+void GPSWaypoints::begin(WAYPOINT_READ readFunction, const void* table, uint16_t size)
+{
+	read = readFunction;
+	source = table;
+	count = readFunction ? size : 0;
+}
+
+uint16_t GPSWaypoints::getCount()
+{
+	return count;
+}
+
+/* ------------------------------------------------------------ */
+/*  get()
+**
+**  Return Value:
+**    false if index is past the end of the table
+*/
+bool GPSWaypoints::get(uint16_t index, WAYPOINT* wp)
+{
+	if (index >= count){
+		return false;
+	}
+	read(source, index, wp);
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  isSorted()
+**
+**  Return Value:
+**    true if the latitudes never decrease, as nearest() needs
+*/
+bool GPSWaypoints::isSorted()
+{
+	WAYPOINT prev, wp;
+	uint16_t i;
+
+	for (i = 1; i < count; i++){
+		read(source, i - 1, &prev);
+		read(source, i, &wp);
+		if (wp.LAT < prev.LAT){
+			return false;
+		}
+	}
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  nearest()
+**
+**  Parameters:
+**	  latE7, lonE7: the fix, in 1e-7 degrees
+**	  matches: set to the closest waypoints, closest first
+**	  n: size of matches
+**	  model: how the distances and bearings in matches are worked out
+**
+**  Return Value:
+**    the number of matches filled in, less than n only if the table
+**	  holds fewer than n waypoints
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    The search ranks waypoints on the plane tangent at the fix
+**	  (GEO_FAST). It starts at the fix's latitude in the table and
+**	  moves north and south, always to the side whose next waypoint is
+**	  nearer in latitude. A side is finished once its next waypoint is
+**	  further north or south than the nth closest found so far, since
+**	  every waypoint past it is further still. The matches are then
+**	  worked out again with model.
+*/
+uint8_t GPSWaypoints::nearest(int32_t latE7, int32_t lonE7, WAYPOINT_MATCH* matches, uint8_t n, GEO_MODEL model)
+{
+	GEO_REF here;
+	WAYPOINT wp, above, below;
+	uint16_t north = lowerBound(latE7);	//Index of above, the next waypoint going north
+	uint16_t south = north;				//One past the index of below, the next going south
+	uint8_t found = 0;
+	uint8_t i;
+	uint16_t index;
+	float dNorth, dSouth, east, offNorth, distance;
+
+	if (n == 0 || count == 0){
+		return 0;
+	}
+	geoSetReference(&here, latE7, lonE7);
+	if (north < count){
+		read(source, north, &above);
+	}
+	if (south > 0){
+		read(source, south - 1, &below);
+	}
+
+	while (north < count || south > 0){
+		dNorth = (north < count) ? (float)(above.LAT - latE7) * here.NORTH : INFINITY;
+		dSouth = (south > 0) ? (float)(latE7 - below.LAT) * here.NORTH : INFINITY;
+		if (dNorth <= dSouth){
+			distance = dNorth;
+			wp = above;
+			index = north++;
+			if (north < count){
+				read(source, north, &above);
+			}
+		}
+		else{
+			distance = dSouth;
+			wp = below;
+			index = --south;
+			if (south > 0){
+				read(source, south - 1, &below);
+			}
+		}
+		if (found == n && distance >= matches[n - 1].VECTOR.DISTANCE){
+			break;//The nearer side is already too far, so is the other
+		}
+
+		geoOffset(&here, wp.LAT, wp.LON, &east, &offNorth);
+		distance = sqrtf(east * east + offNorth * offNorth);
+		if (found < n || distance < matches[n - 1].VECTOR.DISTANCE){
+			i = (found < n) ? found++ : n - 1;
+			while (i > 0 && matches[i - 1].VECTOR.DISTANCE > distance){
+				matches[i] = matches[i - 1];
+				i--;
+			}
+			matches[i].INDEX = index;
+			matches[i].VECTOR.DISTANCE = distance;
+			matches[i].VECTOR.BEARING = 0;
+		}
+	}
+
+	for (i = 0; i < found; i++){
+		toWaypoint(matches[i].INDEX, latE7, lonE7, model, &matches[i].VECTOR);
+	}
+	return found;
+}
+
+/* ------------------------------------------------------------ */
+/*  toWaypoint()
+**
+**  Parameters:
+**	  index: the waypoint
+**	  latE7, lonE7: the fix, in 1e-7 degrees
+**	  model: GEO_FAST, GEO_HAVERSINE or GEO_VINCENTY
+**	  result: set to the distance and bearing from the fix to the
+**			waypoint
+**
+**  Return Value:
+**    false if index is past the end of the table or the model failed,
+**	  see geoInverse()
+*/
+bool GPSWaypoints::toWaypoint(uint16_t index, int32_t latE7, int32_t lonE7, GEO_MODEL model, GEO_VECTOR* result)
+{
+	GEO_REF ref;
+	WAYPOINT wp;
+
+	if (!get(index, &wp)){
+		return false;
+	}
+	geoSetReference(&ref, wp.LAT, wp.LON);
+	return geoInverse(&ref, latE7, lonE7, model, result);
+}
+
+/* ------------------------------------------------------------ */
+/*					Private Functions							*/
+
+/* ------------------------------------------------------------ */
+/*  lowerBound()
+**
+**  Return Value:
+**    index of the first waypoint at or north of latE7, count if
+**	  there is none
+*/
+uint16_t GPSWaypoints::lowerBound(int32_t latE7)
+{
+	uint16_t low = 0;
+	uint16_t high = count;
+	uint16_t mid;
+	WAYPOINT wp;
+
+	while (low < high){
+		mid = low + (high - low) / 2;
+		read(source, mid, &wp);
+		if (wp.LAT < latE7){
+			low = mid + 1;
+		}
+		else{
+			high = mid;
+		}
+	}
+	return low;
+}
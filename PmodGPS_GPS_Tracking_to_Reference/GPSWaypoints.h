@@ -0,0 +1,76 @@
+/************************************************************************/
+/*																		*/
+/*	GPSWaypoints.h  Stored waypoints and nearest waypoint queries		*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Reads a table of waypoints through a WAYPOINT_READ function, so		*/
+/*	the table can be kept in PROGMEM (waypointReadProgmem), RAM			*/
+/*	(waypointReadRam) or EEPROM, for example:							*/
+/*																		*/
+/*	  void readEEPROM(const void* source, uint16_t index, WAYPOINT* wp)	*/
+/*	  {																	*/
+/*		EEPROM.get((uintptr_t)source + index * sizeof(WAYPOINT), *wp);	*/
+/*	  }																	*/
+/*																		*/
+/*	The table must be sorted by latitude, south first. nearest() then	*/
+/*	binary searches for the fix's latitude and works outwards, and		*/
+/*	stops once the latitude difference alone is further than the		*/
+/*	waypoints already found, so it only reads the waypoints in a		*/
+/*	latitude band around the fix rather than the whole table. Does not	*/
+/*	depend on Arduino.h so it can also be built on a host computer.		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSWaypoints_H
+#define GPSWaypoints_H
+
+#include <stdint.h>
+#include "GPSgeo.h"
+
+#define WAYPOINT_NONE  0xFFFF	//Index returned when there is no waypoint
+
+typedef struct WAYPOINT_T{
+	int32_t LAT;		//1e-7 degrees, as in FIX
+	int32_t LON;		//1e-7 degrees
+}WAYPOINT;
+
+typedef struct WAYPOINT_MATCH_T{
+	uint16_t INDEX;		//Position of the waypoint in the table
+	GEO_VECTOR VECTOR;	//Distance and bearing from the fix to the waypoint
+}WAYPOINT_MATCH;
+
+typedef void (*WAYPOINT_READ)(const void* source, uint16_t index, WAYPOINT* wp);
+
+void waypointReadProgmem(const void* source, uint16_t index, WAYPOINT* wp);
+void waypointReadRam(const void* source, uint16_t index, WAYPOINT* wp);
+
+class GPSWaypoints
+{
+	public:
+	GPSWaypoints();
+
+	void begin(WAYPOINT_READ read, const void* source, uint16_t count);
+	uint16_t getCount();
+	bool get(uint16_t index, WAYPOINT* wp);
+	bool isSorted();
+
+	uint8_t nearest(int32_t latE7, int32_t lonE7, WAYPOINT_MATCH* matches, uint8_t n, GEO_MODEL model);
+	bool toWaypoint(uint16_t index, int32_t latE7, int32_t lonE7, GEO_MODEL model, GEO_VECTOR* result);
+
+	private:
+	uint16_t lowerBound(int32_t latE7);
+
+	WAYPOINT_READ read;
+	const void* source;
+	uint16_t count;
+};
+
+#endif //GPSWaypoints_H
@@ -0,0 +1,83 @@
+/************************************************************************/
+/*																		*/
+/*	GPScoord.cpp  Integer decoding of NMEA latitude and longitude fields	*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include "GPScoord.h"
+
+#define MINUTE_DECIMALS  6	//Decimal places of minutes kept, 1e-6 minute = 1/6 of 1e-7 degree
+
+/* ------------------------------------------------------------ */
+/*  decodeCoordinate()
+**
+**  Parameters:
+**	  str: a ddmm.mmmm (latitude) or dddmm.mmmm (longitude) field,
+**			does not need to be null terminated
+**	  len: the number of characters in the field
+**	  hemisphere: the N/S or E/W character that follows the field
+**	  degE7: set to the coordinate in 1e-7 degrees, negative for S and W
+**
+**  Return Value:
+**    true if the field was decoded, false if it was empty or malformed
+**
+**  Errors:
+**    degE7 is left unchanged when false is returned
+**
+**  Description:
+**    The two digits before the '.' and the decimals that follow are
+**	  minutes, any digits before them are degrees. Up to six decimal
+**	  places of minutes are used, which covers every precision the
+**	  PmodGPS prints, and the result is rounded to the nearest 1e-7
+**	  degree. No floating point is used.
+*/
+bool decodeCoordinate(const char* str, uint8_t len, char hemisphere, int32_t* degE7)
+{
+	uint32_t degrees = 0;
+	uint32_t minutes = 0;	//1e-6 minutes
+	uint8_t decimals = 0;
+	uint8_t dot = 0;
+	uint8_t i;
+	char c;
+
+	while (dot < len && str[dot] != '.'){
+		if (str[dot] < '0' || str[dot] > '9'){
+			return false;
+		}
+		dot++;
+	}
+	if (dot < 3 || dot > 5){//At least one degree digit, at most three
+		return false;
+	}
+
+	for (i = 0; i < dot - 2; i++){
+		degrees = degrees * 10 + (str[i] - '0');
+	}
+	minutes = (str[dot - 2] - '0') * 10 + (str[dot - 1] - '0');
+	for (i = dot + 1; i < len && decimals < MINUTE_DECIMALS; i++, decimals++){
+		c = str[i];
+		if (c < '0' || c > '9'){
+			return false;
+		}
+		minutes = minutes * 10 + (c - '0');
+	}
+	for (; decimals < MINUTE_DECIMALS; decimals++){
+		minutes *= 10;
+	}
+	if (degrees > 180 || minutes >= 60000000UL){
+		return false;
+	}
+
+	//1e-6 minute / 60 * 1e7 = 1e-6 minute / 6 in 1e-7 degrees, rounded
+	*degE7 = (int32_t)(degrees * COORD_SCALE + (minutes + 3) / 6);
+	if (hemisphere == 'S' || hemisphere == 'W'){
+		*degE7 = -*degE7;
+	}
+	return true;
+}
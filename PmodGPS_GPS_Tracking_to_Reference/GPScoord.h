@@ -0,0 +1,30 @@
+/************************************************************************/
+/*																		*/
+/*	GPScoord.h  Integer decoding of NMEA latitude and longitude fields	*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Converts the ddmm.mmmm / dddmm.mmmm coordinates sent by the PmodGPS	*/
+/*	straight into signed decimal degrees scaled by 1e7, using integer	*/
+/*	arithmetic only. Does not depend on Arduino.h so it can also be		*/
+/*	built on a host computer.											*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPScoord_H
+#define GPScoord_H
+
+#include <stdint.h>
+
+#define COORD_SCALE  10000000L	//1e-7 degree units per degree
+
+bool decodeCoordinate(const char* str, uint8_t len, char hemisphere, int32_t* degE7);
+
+#endif //GPScoord_H
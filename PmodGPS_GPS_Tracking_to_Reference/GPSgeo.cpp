@@ -0,0 +1,363 @@
+/************************************************************************/
+/*																		*/
+/*	GPSgeo.cpp  Distance and bearing between two positions				*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#include <math.h>
+#include <string.h>
+#include "GPSgeo.h"
+#include "GPScoord.h"
+
+#define GEO_PI			3.14159265358979323846
+#define E7_TO_RAD		(GEO_PI / 180 / COORD_SCALE)
+#define RAD_TO_DEG_F	(float)(180 / GEO_PI)
+#define HALF_TURN_E7	(180L * COORD_SCALE)
+
+//Convergence limit on the longitude on the auxiliary sphere, radians.
+//Where double is only 32 bit (AVR) the iteration can not get below float resolution.
+#define GEO_VINCENTY_EPS	(sizeof(double) > 4 ? 1e-12 : 1e-6)
+
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#else
+#define PROGMEM
+#define memcpy_P memcpy
+#endif
+
+static const char compassNames[GEO_COMPASS_POINTS][4] PROGMEM = {
+	"N", "NNE", "NE", "ENE", "E", "ESE", "SE", "SSE",
+	"S", "SSW", "SW", "WSW", "W", "WNW", "NW", "NNW"
+};
+
+/* ------------------------------------------------------------ */
+/*  deltaLongitude()
+**
+**  Parameters:
+**	  from, to: longitudes in 1e-7 degrees
+**
+**  Return Value:
+**    to - from in 1e-7 degrees, wrapped into -180 to 180 degrees
+**
+**  Description:
+**    Paths are taken the short way around, across the antimeridian
+**	  when that is shorter.
+*/
+static int32_t deltaLongitude(int32_t from, int32_t to)
+{
+	int64_t diff = (int64_t)to - from;	//Up to 360 degrees, too wide for int32_t
+
+	if (diff > HALF_TURN_E7){
+		diff -= 2 * (int64_t)HALF_TURN_E7;
+	}
+	else if (diff < -HALF_TURN_E7){
+		diff += 2 * (int64_t)HALF_TURN_E7;
+	}
+	return (int32_t)diff;
+}
+
+/* ------------------------------------------------------------ */
+/*  geoBearing()
+**
+**  Parameters:
+**	  east, north: components of the direction, any common scale
+**
+**  Return Value:
+**    degrees clockwise from true north, 0 to <360
+**
+**  Errors:
+**    0 when both components are 0
+**
+**  Description:
+**    One atan2() gives -180 to 180 degrees. The quadrant correction is
+**	  done with the comparison results as 0/1 factors rather than with
+**	  branches. The second correction is for tiny negative angles,
+**	  where -0.00001 + 360 rounds up to 360 in float.
+*/
+float geoBearing(float east, float north)
+{
+	float bearing = atan2f(east, north) * RAD_TO_DEG_F;
+
+	bearing += 360.0f * (bearing < 0);
+	bearing -= 360.0f * (bearing >= 360.0f);
+	return bearing;
+}
+
+/* ------------------------------------------------------------ */
+/*  geoCompassIndex()
+**
+**  Parameters:
+**	  bearing: degrees clockwise from true north, 0 to <360
+**
+**  Return Value:
+**    the nearest of the 16 compass points, 0 = N, 4 = E, 8 = S, 12 = W
+**
+**  Description:
+**    Each point covers 22.5 degrees centred on its direction, so the
+**	  bearing is offset by half a sector and scaled to sectors. The
+**	  mask folds 348.75 to <360 back onto N.
+*/
+uint8_t geoCompassIndex(float bearing)
+{
+	return (uint8_t)((uint16_t)(bearing * (GEO_COMPASS_POINTS / 360.0f) + 0.5f) & (GEO_COMPASS_POINTS - 1));
+}
+
+/* ------------------------------------------------------------ */
+/*  geoCompassName()
+**
+**  Parameters:
+**	  index: compass point from geoCompassIndex()
+**	  name: buffer of at least 4 bytes, set to the point's abbreviation
+**
+**  Return Value:
+**    name
+**
+**  Description:
+**    The names are kept in program memory on AVR.
+*/
+char* geoCompassName(uint8_t index, char* name)
+{
+	memcpy_P(name, compassNames[index & (GEO_COMPASS_POINTS - 1)], sizeof(compassNames[0]));
+	return name;
+}
+
+/* ------------------------------------------------------------ */
+/*  geoSetReference()
+**
+**  Parameters:
+**	  ref: filled in for the reference position
+**	  latE7, lonE7: reference position in 1e-7 degrees, as in FIX
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Does all the trigonometry that depends only on the reference, so
+**	  GEO_FAST costs a few multiply-adds and a square root per fix and
+**	  the other models only need the trigonometry of the fix itself.
+**	  GEO_FAST uses the meridional and prime vertical radii of the
+**	  WGS-84 ellipsoid at the reference latitude.
+*/
+void geoSetReference(GEO_REF* ref, int32_t latE7, int32_t lonE7)
+{
+	double lat = latE7 * E7_TO_RAD;
+	double e2 = WGS84_F * (2 - WGS84_F);
+	double sinLat = sin(lat);
+	double cosLat = cos(lat);
+	double w2 = 1 - e2 * sinLat * sinLat;
+	double w = sqrt(w2);
+	double tanU = (1 - WGS84_F) * tan(lat);
+
+	ref->LAT = latE7;
+	ref->LON = lonE7;
+	ref->NORTH = (float)(WGS84_A * (1 - e2) / (w2 * w) * E7_TO_RAD);
+	ref->EAST = (float)(WGS84_A / w * cosLat * E7_TO_RAD);
+	ref->SINLAT = sinLat;
+	ref->COSLAT = cosLat;
+	ref->COSU = 1 / sqrt(1 + tanU * tanU);
+	ref->SINU = tanU * ref->COSU;
+}
+
+/* ------------------------------------------------------------ */
+/*  geoOffset()
+**
+**  Parameters:
+**	  ref: the reference, set up by geoSetReference()
+**	  latE7, lonE7: position in 1e-7 degrees, as in FIX
+**	  east, north: set to the position's offset from the reference
+**			in metres, on the plane tangent at the reference
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    The GEO_FAST model, two multiplies per position. Good to about
+**	  0.1% within a few tens of km of the reference.
+*/
+void geoOffset(const GEO_REF* ref, int32_t latE7, int32_t lonE7, float* east, float* north)
+{
+	*north = (float)(latE7 - ref->LAT) * ref->NORTH;
+	*east = (float)deltaLongitude(ref->LON, lonE7) * ref->EAST;
+}
+
+/* ------------------------------------------------------------ */
+/*  geoPosition()
+**
+**  Parameters:
+**	  ref: the reference, set up by geoSetReference()
+**	  east, north: offset from the reference in metres
+**	  latE7, lonE7: set to the position at that offset
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    The inverse of geoOffset(). The longitude is wrapped back into
+**	  -180 to 180 degrees.
+*/
+void geoPosition(const GEO_REF* ref, float east, float north, int32_t* latE7, int32_t* lonE7)
+{
+	int32_t dLon = 0;
+
+	if (ref->EAST > 0){//Zero at the poles
+		dLon = (int32_t)lroundf(east / ref->EAST);
+	}
+	*latE7 = ref->LAT + (int32_t)lroundf(north / ref->NORTH);
+	*lonE7 = deltaLongitude(-ref->LON, dLon);	//ref->LON + dLon without overflow
+}
+
+/* ------------------------------------------------------------ */
+/*  geoFast()
+**
+**  Description:
+**    Flat earth around the reference. Only the scaling of the
+**	  differences and the bearing are computed per fix.
+*/
+static void geoFast(const GEO_REF* ref, int32_t latE7, int32_t lonE7, GEO_VECTOR* result)
+{
+	float north, east;
+
+	geoOffset(ref, latE7, lonE7, &east, &north);
+	result->DISTANCE = sqrtf(north * north + east * east);
+	result->BEARING = geoBearing(-east, -north);	//Back towards the reference
+}
+
+/* ------------------------------------------------------------ */
+/*  geoHaversine()
+**
+**  Description:
+**    Great circle distance and initial bearing on a sphere of radius
+**	  GEO_RADIUS. The haversine form keeps short distances accurate.
+*/
+static void geoHaversine(const GEO_REF* ref, int32_t latE7, int32_t lonE7, GEO_VECTOR* result)
+{
+	double lat = latE7 * E7_TO_RAD;
+	double dLat = (ref->LAT - latE7) * E7_TO_RAD;
+	double dLon = deltaLongitude(lonE7, ref->LON) * E7_TO_RAD;
+	double sinLat = sin(lat);
+	double cosLat = cos(lat);
+	double sinHalfLat = sin(dLat / 2);
+	double sinHalfLon = sin(dLon / 2);
+	double h = sinHalfLat * sinHalfLat + cosLat * ref->COSLAT * sinHalfLon * sinHalfLon;
+
+	result->DISTANCE = (float)(2 * GEO_RADIUS * atan2(sqrt(h), sqrt(1 - h)));
+	result->BEARING = geoBearing(sin(dLon) * ref->COSLAT,
+		cosLat * ref->SINLAT - sinLat * ref->COSLAT * cos(dLon));
+}
+
+/* ------------------------------------------------------------ */
+/*  geoVincenty()
+**
+**  Return Value:
+**    false if the iteration did not converge (nearly antipodal points)
+**
+**  Description:
+**    Vincenty's inverse formula on the WGS-84 ellipsoid.
+*/
+static bool geoVincenty(const GEO_REF* ref, int32_t latE7, int32_t lonE7, GEO_VECTOR* result)
+{
+	double b = WGS84_A * (1 - WGS84_F);
+	double L = deltaLongitude(lonE7, ref->LON) * E7_TO_RAD;
+	double tanU1 = (1 - WGS84_F) * tan(latE7 * E7_TO_RAD);
+	double cosU1 = 1 / sqrt(1 + tanU1 * tanU1);
+	double sinU1 = tanU1 * cosU1;
+	double sinU2 = ref->SINU;
+	double cosU2 = ref->COSU;
+	double lambda = L;
+	double lambdaPrev;
+	double sinLambda, cosLambda;
+	double sinSigma, cosSigma, sigma;
+	double sinAlpha, cos2Alpha, cos2SigmaM;
+	double C, u2, A, B, deltaSigma;
+	uint8_t i = 0;
+
+	do{
+		sinLambda = sin(lambda);
+		cosLambda = cos(lambda);
+		sinSigma = sqrt((cosU2 * sinLambda) * (cosU2 * sinLambda) +
+			(cosU1 * sinU2 - sinU1 * cosU2 * cosLambda) * (cosU1 * sinU2 - sinU1 * cosU2 * cosLambda));
+		if (sinSigma == 0){//Same position
+			result->DISTANCE = 0;
+			result->BEARING = 0;
+			return true;
+		}
+		cosSigma = sinU1 * sinU2 + cosU1 * cosU2 * cosLambda;
+		sigma = atan2(sinSigma, cosSigma);
+		sinAlpha = cosU1 * cosU2 * sinLambda / sinSigma;
+		cos2Alpha = 1 - sinAlpha * sinAlpha;
+		cos2SigmaM = (cos2Alpha != 0) ? cosSigma - 2 * sinU1 * sinU2 / cos2Alpha : 0;	//0 on the equator
+		C = WGS84_F / 16 * cos2Alpha * (4 + WGS84_F * (4 - 3 * cos2Alpha));
+		lambdaPrev = lambda;
+		lambda = L + (1 - C) * WGS84_F * sinAlpha *
+			(sigma + C * sinSigma * (cos2SigmaM + C * cosSigma * (-1 + 2 * cos2SigmaM * cos2SigmaM)));
+	}while (fabs(lambda - lambdaPrev) > GEO_VINCENTY_EPS && ++i < GEO_VINCENTY_ITERATIONS);
+
+	if (i >= GEO_VINCENTY_ITERATIONS){
+		return false;
+	}
+
+	u2 = cos2Alpha * (WGS84_A * WGS84_A - b * b) / (b * b);
+	A = 1 + u2 / 16384 * (4096 + u2 * (-768 + u2 * (320 - 175 * u2)));
+	B = u2 / 1024 * (256 + u2 * (-128 + u2 * (74 - 47 * u2)));
+	deltaSigma = B * sinSigma * (cos2SigmaM + B / 4 * (cosSigma * (-1 + 2 * cos2SigmaM * cos2SigmaM) -
+		B / 6 * cos2SigmaM * (-3 + 4 * sinSigma * sinSigma) * (-3 + 4 * cos2SigmaM * cos2SigmaM)));
+
+	result->DISTANCE = (float)(b * A * (sigma - deltaSigma));
+	result->BEARING = geoBearing(cosU2 * sinLambda, cosU1 * sinU2 - sinU1 * cosU2 * cosLambda);
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  geoInverse()
+**
+**  Parameters:
+**	  ref: the reference, set up by geoSetReference()
+**	  latE7, lonE7: current position in 1e-7 degrees, as in FIX
+**	  model: GEO_FAST, GEO_HAVERSINE or GEO_VINCENTY
+**	  result: set to the distance from the position to the reference
+**			and the initial bearing to follow from the position
+**
+**  Return Value:
+**    true, or false if GEO_VINCENTY did not converge
+**
+**  Errors:
+**    When GEO_VINCENTY fails to converge, which only happens for
+**	  nearly antipodal points, result holds the GEO_HAVERSINE answer
+**
+**  Description:
+**    Distance and bearing come out of the same call so the
+**	  trigonometry they share is only done once.
+*/
+bool geoInverse(const GEO_REF* ref, int32_t latE7, int32_t lonE7, GEO_MODEL model, GEO_VECTOR* result)
+{
+	switch (model){
+	case GEO_VINCENTY:
+		if (geoVincenty(ref, latE7, lonE7, result)){
+			return true;
+		}
+		geoHaversine(ref, latE7, lonE7, result);
+		return false;
+	case GEO_HAVERSINE:
+		geoHaversine(ref, latE7, lonE7, result);
+		return true;
+	case GEO_FAST:
+	default:
+		geoFast(ref, latE7, lonE7, result);
+		return true;
+	}
+}
@@ -0,0 +1,75 @@
+/************************************************************************/
+/*																		*/
+/*	GPSgeo.h  Distance and bearing between two positions				*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Solves the inverse geodesic problem (distance and initial bearing	*/
+/*	from a position to a reference) with three models of increasing	*/
+/*	accuracy and cost:													*/
+/*	  GEO_FAST		flat earth around the reference, scaled by the		*/
+/*					WGS-84 radii of curvature at the reference latitude	*/
+/*					good to about 0.1% within a few tens of km			*/
+/*	  GEO_HAVERSINE	great circle on a sphere, error up to about 0.5%	*/
+/*					at any distance										*/
+/*	  GEO_VINCENTY	WGS-84 ellipsoid, sub-millimetre where double is	*/
+/*					64 bit, limited by float precision on AVR			*/
+/*	geoBearing() and geoCompassIndex() turn a direction into degrees	*/
+/*	from true north and one of 16 compass points.						*/
+/*	Positions are the 1e-7 degree integers kept in FIX. Does not		*/
+/*	depend on Arduino.h so it can also be built on a host computer.		*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef GPSgeo_H
+#define GPSgeo_H
+
+#include <stdint.h>
+
+#define WGS84_A		6378137.0				//Semi-major axis, metres
+#define WGS84_F		(1 / 298.257223563)		//Flattening
+#define GEO_RADIUS	6371008.8				//Mean earth radius for GEO_HAVERSINE, metres
+
+#define GEO_VINCENTY_ITERATIONS 20
+#define GEO_COMPASS_POINTS		16		//Power of two
+
+typedef enum{
+	GEO_FAST,
+	GEO_HAVERSINE,
+	GEO_VINCENTY
+}GEO_MODEL;
+
+//Everything about the reference position that does not change between fixes
+typedef struct{
+	int32_t LAT;		//1e-7 degrees
+	int32_t LON;		//1e-7 degrees
+	float NORTH;		//GEO_FAST metres per 1e-7 degree of latitude
+	float EAST;			//GEO_FAST metres per 1e-7 degree of longitude
+	double SINLAT;		//GEO_HAVERSINE
+	double COSLAT;
+	double SINU;		//GEO_VINCENTY reduced latitude
+	double COSU;
+}GEO_REF;
+
+typedef struct{
+	float DISTANCE;		//metres
+	float BEARING;		//degrees clockwise from true north, 0 to <360
+}GEO_VECTOR;
+
+void geoSetReference(GEO_REF* ref, int32_t latE7, int32_t lonE7);
+bool geoInverse(const GEO_REF* ref, int32_t latE7, int32_t lonE7, GEO_MODEL model, GEO_VECTOR* result);
+void geoOffset(const GEO_REF* ref, int32_t latE7, int32_t lonE7, float* east, float* north);
+void geoPosition(const GEO_REF* ref, float east, float north, int32_t* latE7, int32_t* lonE7);
+
+float geoBearing(float east, float north);
+uint8_t geoCompassIndex(float bearing);
+char* geoCompassName(uint8_t index, char* name);
+
+#endif //GPSgeo_H
@@ -23,20 +23,6 @@
 /************************************************************************/
 /*	Needs work:																											*/
 /*																																	*/
-/*  	Does not yet support other messages that can be received on startup			*/
-/*		These messages are not important to the general operation of the PmodGPS			*/
-/*																														*/
-/*																																	*/
-/*		The data sent from the PmodGPS includes a checksum. a private							*/
-/*		function could be created to check the checksum against the							*/
-/*		packet, and throw a flag if the packet is in error.												*/
-/*		Because the data is updated every second, this isn't important.						*/
-/*																																	*/
-/*		A send command packet function still needs to be implemented.					*/
-/*																																	*/
-/*		A timeout needs to be implemented in the gatData function in case the PmodGPS 	*/
-/*		is unplugged or interrupted during receive.														*/
-/*																																	*/
 /*																																	*/
 /*		For the PmodGPS datasheet, refer to:															*/
 /*		https://www.maritex.com.pl/media/uploads/products/wi/GPS-GMS-U1LP.pdf */
@@ -60,6 +46,148 @@
 
 
 #include "PmodGPS.h"
+#include "GPScoord.h"
+#include "GPSFormat.h"
+
+#if GPS_USE_STRINGS
+static void copyField(char* dest, uint8_t size, const char* data_array, NMEA_FIELD field);
+
+//Keeps the checksum of the sentence just formatted in its struct
+#define KEEP_CHECKSUM(data)	copyField(data.CHECKSUM, sizeof(data.CHECKSUM), sentence, checksum)
+#else
+#define KEEP_CHECKSUM(data)
+#endif
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR		//Interrupt handlers must be in IRAM on the ESP8266, nothing elsewhere
+#endif
+
+/* ------------------------------------------------------------ */
+/*  hexValue()
+**
+**  Parameters:
+**	  c: a hexadecimal digit, either case
+**
+**  Return Value:
+**    The value of the digit, 0xFF if c is not a hexadecimal digit
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Converts one checksum digit.
+*/
+static uint8_t hexValue(char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	return 0xFF;
+}
+
+/* ------------------------------------------------------------ */
+/*  GPS()
+**
+**  Parameters:
+**    none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Starts the sentence parser in its idle state with empty data.
+*/
+GPS::GPS()
+{
+	port = NULL;
+	ppsPin = GPS_NO_PIN;
+	dfPin = GPS_NO_PIN;
+	sentenceLen = 0;
+	checksumCalc = 0;
+	checksumPos = 0;
+	uartOverruns = 0;
+	epochUTC = 0xFFFFFFFF;
+	epochMask = 0;
+	epochRequired = EPOCH_DEFAULT;
+	epochDone = false;
+	epochSequence = 0;
+	memset(&epochFix, 0, sizeof(epochFix));
+	memset(sequence, 0, sizeof(sequence));
+#if GPS_USE_STRINGS
+#if GPS_USE_GGA
+	memset(&GGAdata, 0, sizeof(GGAdata));
+#endif
+#if GPS_USE_GSA
+	memset(&GSAdata, 0, sizeof(GSAdata));
+#endif
+#if GPS_USE_GSV
+	memset(&GSVdata, 0, sizeof(GSVdata));
+#endif
+#if GPS_USE_RMC
+	memset(&RMCdata, 0, sizeof(RMCdata));
+#endif
+#if GPS_USE_VTG
+	memset(&VTGdata, 0, sizeof(VTGdata));
+#endif
+#if GPS_USE_GLL
+	memset(&GLLdata, 0, sizeof(GLLdata));
+#endif
+#if GPS_USE_ZDA
+	memset(&ZDAdata, 0, sizeof(ZDAdata));
+#endif
+#if GPS_USE_TXT
+	memset(&TXTdata, 0, sizeof(TXTdata));
+#endif
+#if GPS_USE_ACK
+	memset(&ACKdata, 0, sizeof(ACKdata));
+#endif
+#endif
+#if GPS_USE_GSV
+	memset(sky, 0, sizeof(sky));
+	skyFront = 0;
+	skyEpoch = 0;
+	gsvTalker = 0;
+	gsvNext = 0;
+#endif
+	gsvDone = false;
+#if GPS_USE_PPS
+	ppsMicros = 0;
+	ppsCount = 0;
+	ppsMode = 0;
+	ppsLevel = LOW;
+	ppsUsed = 0;
+	ppsTied = false;
+	ppsUTC = 0;
+	ppsLocal = 0;
+	sentenceMicros = 0;
+	stampHead = 0;
+	stampTail = 0;
+	memset(&fixTime, 0, sizeof(fixTime));
+#endif
+#if GPS_USE_DF
+	dfEdgeMillis = 0;
+	dfToggleMillis = 0;
+	dfMode = 0;
+	dfLevel = LOW;
+	dfStable = LOW;
+	dfSeen = false;
+#endif
+#if GPS_USE_ACK
+	commandLen = 0;
+	commandSent = 0;
+	commandNumber = 0;
+	commandTries = 0;
+	commandState = CMD_IDLE;
+	commandFlag = 0;
+	commandTime = 0;
+#endif
+	talker = 0;
+	memset(&fix, 0, sizeof(fix));
+	clearStats();
+}
 
 /* ------------------------------------------------------------ */
 /*  GPSinit()
@@ -82,6 +210,9 @@
 */
 void GPS::GPSinit(HardwareSerial &serPort, unsigned long baud, uint8_t DF, uint8_t PPS)
 {
+	port = &serPort;
+	ppsPin = PPS;
+	dfPin = DF;
 	serPort.begin(baud);
 	pinMode(DF, INPUT);
 	pinMode(PPS, INPUT);
@@ -110,880 +241,2262 @@ void GPS::GPSinit(HardwareSerial &serPort, unsigned long baud, uint8_t DF, uint8
 */
 void GPS::GPSinit(HardwareSerial &serPort, unsigned long baud, uint8_t DF, uint8_t PPS, uint8_t RST)
 {
+	port = &serPort;
+	ppsPin = PPS;
+	dfPin = DF;
 	serPort.begin(baud);
 	pinMode(DF, INPUT);
 	pinMode(PPS, INPUT);
 	pinMode(RST, OUTPUT);
 	digitalWrite(RST, LOW);
 	digitalWrite(RST, HIGH);
-	getData(serPort);//Receive restart command 
-	getData(serPort);//Receive start up command
-	getData(serPort);//PGACK command sent
-	getData(serPort);//PGACK command sent
+	//The restart, start up and PGACK messages that follow are not
+	//NMEA position sentences, feed() discards them as they arrive
 }
 
+#if GPS_USE_ACK
 /* ------------------------------------------------------------ */
-/*  getData()
+/*  GPSinitAutoBaud()
 **
 **  Parameters:
-**	  serPort: The HardwareSerial port (Serial1, Serial2, etc) from
-**				MPIDE that will be used to communicate with the PmodGPS
+**    serPort: The HardwareSerial port the PmodGPS is connected to
+**	  baud: The rate to run the PmodGPS at, 57600 or 115200 for
+**			update rates above 5 Hz
+**    DF: The digital pin number of the 3DF pin on the PmodGPS
+**    PPS: The digital pin number of the 1PPS pin on the PmodGPS
 **
 **  Return Value:
-**    The type of sentence that was recieved.
+**    The rate the port and the PmodGPS were left at, 0 if nothing
+**	  was heard from the PmodGPS
 **
 **  Errors:
-**    none
+**    If the PmodGPS is not heard at baud after the change, the port
+**	  goes back to the rate that was detected and that is returned.
 **
 **  Description:
-**    Does a read of data. finishes when a value of decimal
-**	  10 (ASCII <LF>) is detected. Reads the first three characters to
-**	  verify the packet starts with $GP, then checks the next three
-**	  to decide which struct to parse the data into.
+**    Initialize the system without knowing the PmodGPS's rate, which
+**	  goes back to 9600 whenever its backup power is lost. The rate is
+**	  measured with detectBaudrate(), then changed to baud with
+**	  $PMTK251 if it differs, and the port is only left at the new
+**	  rate once a sentence with a good checksum has been received at
+**	  it. Waits up to GPS_DETECT_TIMEOUT + 2 * GPS_SYNC_TIMEOUT ms, so
+**	  call it from setup().
 */
-NMEA GPS::getData(HardwareSerial &serPort)
+unsigned long GPS::GPSinitAutoBaud(HardwareSerial &serPort, unsigned long baud, uint8_t DF, uint8_t PPS)
 {
-	char recv[MAX_SIZE]={0};
-	int i;
-	int count = 0;
-	char checksum[3];
-	NMEA mode= INVALID;
-
-	if (serPort.available()){	//If there is a sentence
-		recv[0] = serPort.read();
-		//Get the sentence
-		for(i = 1; i < MAX_SIZE; i++){
-			while(!serPort.available());//Wait for serial to be ready
-			recv[i] = serPort.read();
-			if(recv[i] == 10){//End of sentence
-				break;
-			}
-		}
+	unsigned long detected;
+
+	GPSinit(serPort, GPS_DEFAULT_BAUD, DF, PPS);
+	detected = serPort.detectBaudrate(GPS_DETECT_TIMEOUT);
+	if (detected == 0 || !resync(serPort, detected)){
+		return 0;
 	}
-	else{
-		return INVALID;
+	if (detected == baud){
+		return baud;
 	}
-	//Decide what kind of sentence was received
-	mode=chooseMode(recv);
-	
-	//Debugging purposes
-	//Serial.print("\n\n Message received: ");Serial.println(recv); //This is the full sentence sent from the PmodGPS
-
-	//Format the sentence into structs
-		switch(mode){
-			case(GGA):formatGGA(recv);
-				break;
-			case(GSA):formatGSA(recv);
-				break;
-			case(GSV):formatGSV(recv);
-				break;
-			case(RMC):formatRMC(recv);
-				break;
-			case(VTG):formatVTG(recv);
-				break;
-			case(INVALID):return INVALID;
+	if (!setBaudrate(baud)){
+		return detected;
+	}
+	while (updateCommand() == CMD_SENDING){//The port's transmit buffer may be smaller than the command
+	}
+	serPort.flush();//The last byte must be out before the port changes rate
+	if (resync(serPort, baud)){
+		if (commandState == CMD_WAITING){//Hearing the PmodGPS at baud is the acknowledgement
+			commandState = CMD_DONE;
 		}
-	
-	
-	return(mode);//Return the type of sentence that was sent
+		return baud;
+	}
+	resync(serPort, detected);
+	return detected;
 }
 
 /* ------------------------------------------------------------ */
-/* 	getGGA(), getGSA(), getGSV(), getRMC(), getVTG()
+/*  resync()
 **
 **  Parameters:
-**	  none
+**	  serPort: The HardwareSerial port the PmodGPS is connected to
+**	  baud: The rate to set the port to
 **
 **  Return Value:
-**    The struct containing the data from the $GPXXX sentence
+**    true if a sentence with a good checksum arrived at baud within
+**	  GPS_SYNC_TIMEOUT ms
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Get functions for the private structs in the PmodGPS class
+**    Sets the port's rate and drops everything received before it,
+**	  including any partial sentence, then listens at the new rate.
 */
-GGA_DATA GPS::getGGA()
-{
-	return GGAdata;
-}
-GSA_DATA GPS::getGSA()
+bool GPS::resync(HardwareSerial &serPort, unsigned long baud)
 {
-	return GSAdata;
-}
-GSV_DATA GPS::getGSV()
-{
-	return GSVdata;
-}
-RMC_DATA GPS::getRMC()
-{
-	return RMCdata;
-}
-VTG_DATA GPS::getVTG()
-{
-	return VTGdata;
-}
-
+	unsigned long start;
 
-/* ------------------------------------------------------------ */
-/*  isFixed()
-**
-**  Parameters:
-**	  none
-**
-**  Return Value:
-**    bool PFI
-**
-**  Errors:
-**    none
-**
-**  Description:
-**    Returns a true if PFI is 1, else 0
-*/
-bool GPS::isFixed(){
-	if ((int)(GGAdata.PFI-'0')==1)
-	{
-		return true;
+	serPort.begin(baud);
+	while (serPort.available()){
+		serPort.read();
 	}
-	else
-	{
-		return false;
+	noInterrupts();//The ring may be filled by a receive ISR
+	rxRing.clear();
+#if GPS_USE_PPS
+	stampTail = stampHead;
+#endif
+	interrupts();
+	sentenceLen = 0;
+	start = millis();
+	while (millis() - start < GPS_SYNC_TIMEOUT){
+		if (getData(serPort) != INVALID){
+			return true;
+		}
+		yield();
 	}
+	return false;
 }
-
+#endif
 
 /* ------------------------------------------------------------ */
-/*  getLatitude(), getLongitude()
+/*  getData()
 **
 **  Parameters:
-**	  none
+**	  serPort: The HardwareSerial port (Serial1, Serial2, etc) from
+**				MPIDE that will be used to communicate with the PmodGPS
 **
 **  Return Value:
-**    A string containing the data requested
+**    The type of sentence that was recieved, INVALID if no complete
+**	  sentence was waiting.
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Get functions for several data members in string form
+**    Moves whatever bytes the port has ready into the receive ring,
+**	  then parses from the ring without waiting for the rest of the
+**	  sentence. See ingest() and poll().
 */
-char* GPS::getLatitude(){
-	return GGAdata.LAT;
-}
-
-char* GPS::getLongitude(){
-	return GGAdata.LONG;
+NMEA GPS::getData(HardwareSerial &serPort)
+{
+	ingest(serPort);
+	return poll();
 }
 
-
 /* ------------------------------------------------------------ */
-/*  getAltitudeString()
+/*  ingest()
 **
 **  Parameters:
-**	  none
+**	  serPort: The HardwareSerial port the PmodGPS is connected to
 **
 **  Return Value:
-**    A string containing the altitude with appended units
+**    none
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Gets altitude and returns its value with units in string form
+**    Producer side of the receive ring. Copies the bytes the port
+**	  has received into the ring, leaving any that do not fit in the
+**	  port, and notes if the port's own buffer overran. Call it
+**	  from serialEvent(), yield() (which delay() calls on AVR) or a
+**	  timer so bytes keep being collected while the application is
+**	  busy; each '$' is timestamped here, see pushByte(). Also polls
+**	  the 1PPS and 3DF pins if they have no interrupt, see pollPPS()
+**	  and pollFixPin().
 */
-char* GPS::getAltitudeString(){
-	char altitude[11]={0};
-	char unit[2]={0};
-	
-	unit[0]=GGAdata.AUNIT;
-	strcpy(altitude, GGAdata.ALT);
-	strcat(altitude," ");
-	strcat(altitude,unit);
-	return altitude;
+void GPS::ingest(HardwareSerial &serPort)
+{
+	if (serPort.hasOverrun()){
+		uartOverruns++;
+	}
+	while (!rxRing.isFull() && serPort.available()){
+		pushByte(serPort.read());
+	}
+#if GPS_USE_PPS
+	pollPPS();
+#endif
+#if GPS_USE_DF
+	pollFixPin();
+#endif
 }
 
 /* ------------------------------------------------------------ */
-/*  getDate()
+/*  receive()
 **
 **  Parameters:
-**	  none
+**	  c: A byte received from the PmodGPS
 **
 **  Return Value:
-**    A string containing the date in correct format
+**    false if the ring was full and the byte was dropped
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Formats the date and returns it as a char string
+**    Producer side of the receive ring for a custom receive ISR.
+**	  Only stores the byte, parsing is left to poll().
 */
-char* GPS::getDate(){
-	char date[9]={0};
-	char null[1]={0};
-	date[0]=RMCdata.DATE[2];
-	date[1]=RMCdata.DATE[3];
-	date[2]='/';
-	date[3]=RMCdata.DATE[0];
-	date[4]=RMCdata.DATE[1];
-	date[5]='/';
-	date[6]=RMCdata.DATE[4];
-	date[7]=RMCdata.DATE[5];
-	strcat(date,null);
-	return date;
+bool IRAM_ATTR GPS::receive(uint8_t c)
+{
+	return pushByte(c);
 }
 
 /* ------------------------------------------------------------ */
-/*  getTime(), getNumSats(), getPDOP(), getAltitude(), getSpeedKnots(),
-**		getSpeedKM(), getHeading()
+/*  pushByte()
 **
 **  Parameters:
-**	  	none
+**	  c: A byte received from the PmodGPS
 **
 **  Return Value:
-**    The data in the structs in either integer or double form
-**
-**  Errors:
-**    none
+**    false if the ring was full and the byte was dropped
 **
 **  Description:
-**    Get functions for several items in the PmodGPS structs. These
-**		values are converted to integers or doubles before being 
-**		returned.
+**    Puts c in the receive ring, and with GPS_USE_PPS notes when
+**	  each '$' arrived, so the fix time does not depend on how long
+**	  the sentence waited in the ring.
 */
-double GPS::getTime(){
-	return atof(GGAdata.UTC);
-}
-
-int GPS::getNumSats(){
-	return atoi(GGAdata.NUMSAT);
-}
-
-double GPS::getPDOP(){
-	return atof(GSAdata.PDOP);
-}
-
-double GPS::getAltitude(){
-	return atof(GGAdata.ALT);
-}
-
-double GPS::getSpeedKnots(){
-	return atof(VTGdata.SPD_N);
-}
-
-double GPS::getSpeedKM(){
-	return atof(VTGdata.SPD_KM);
-}
+bool IRAM_ATTR GPS::pushByte(uint8_t c)
+{
+#if GPS_USE_PPS
+	uint8_t at = rxRing.getHead();
 
-double GPS::getHeading(){
-	return atof(VTGdata.COURSE_T);
+	if (!rxRing.push(c)){
+		return false;
+	}
+	if (c == '$'){
+		stampSentence(at);
+	}
+	return true;
+#else
+	return rxRing.push(c);
+#endif
 }
 
-
-
 /* ------------------------------------------------------------ */
-/*  getSatelliteInfo()
+/*  getRxStats()
 **
 **  Parameters:
-**	 	none
+**	  none
 **
 **  Return Value:
-**    The array of SATELLITE structs in GSVdata
+**    The receive ring's high-water mark and overrun counts
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    A get function for the SATELLITE structs containing
-**		satellite info.
+**    If highWater gets close to GPS_RX_BUFFER_SIZE or bytes are
+**	  dropped, the ring needs to be bigger or drained more often.
 */
-SATELLITE* GPS::getSatelliteInfo(){
-	return GSVdata.SAT;
-}
-
+RING_STATS GPS::getRxStats()
+{
+	RING_STATS rxStats;
 
-/* ------------------------------------------------------------ */
-/*					Private Functions							*/
-/* ------------------------------------------------------------ */
+	noInterrupts();//dropped may be written by the receive ISR
+	rxStats.highWater = rxRing.getHighWater();
+	rxStats.dropped = rxRing.getDropped();
+	interrupts();
+	rxStats.uartOverruns = uartOverruns;
+	return rxStats;
+}
 
 /* ------------------------------------------------------------ */
-/*  chooseMode()
+/*  poll()
 **
 **  Parameters:
-**	  char recv[MAX_SIZE]
+**	  stream: The Stream the PmodGPS sentences are read from
 **
 **  Return Value:
-**    NMEA mode: The format of the sentence, for use in deciding
-**	   which struct to format into
+**    The type of the first sentence completed during this call,
+**	  INVALID if the bytes available did not complete one.
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Reads the third, fourth, and fifth character in the sentence, and outputs an NMEA mode.
+**    Passes the bytes already received to feed(). Stops after the
+**	  first known sentence is completed so the caller can use its data
+**	  before the next one overwrites it, the remaining bytes stay in
+**	  the port for the next call. Never waits for a byte to arrive.
 */
-NMEA GPS::chooseMode(char recv[MAX_SIZE]){
-	NMEA mode=INVALID;
-	if (((recv[3]) == 'G') && ((recv[4]) == 'G') && (recv[5] == 'A'))
-	{
-		mode=GGA;
-	}
-	else if (((recv[3]) == 'G') && ((recv[4]) == 'S') && (recv[5] == 'A'))
-	{
-		mode=GSA;
-	}
-	else if (((recv[3]) == 'G') && ((recv[4]) == 'S') && (recv[5] == 'V'))
-	{
-		mode=GSV;
-	}
-	else if (((recv[3]) == 'R') && ((recv[4]) == 'M') && (recv[5] == 'C'))
-	{
-		mode=RMC;
-	}
-	else if (((recv[3]) == 'V') && ((recv[4]) == 'T') && (recv[5] == 'G'))
-	{
-		mode=VTG;
+NMEA GPS::poll(Stream &stream)
+{
+	NMEA mode;
+
+	while (stream.available()){
+		mode = feed(stream.read());
+		if (mode != INVALID){
+			return mode;
+		}
 	}
-	return mode;
+	return INVALID;
 }
 
-
 /* ------------------------------------------------------------ */
-/*  formatGGA()
+/*  poll()
 **
 **  Parameters:
-**	  data: an array to the data to be formatted
-**	  GGAdata: a pointer to the GGA_DATA structure to store the parsed data in
+**	  none
 **
 **  Return Value:
-**    none
+**    The type of the first sentence completed during this call,
+**	  INVALID if the bytes in the receive ring did not complete one.
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Formats a mode's data into elements in a struct.
-**		NOTE: ',' will separate all values
+**    Consumer side of the receive ring. Passes the buffered bytes
+**	  to feed() and stops after the first known sentence, the rest
+**	  stay in the ring for the next call.
 */
-void GPS::formatGGA(char* data_array)
+NMEA GPS::poll()
 {
-	enum cases {UTC, LAT, NS, LONG, EW, PFI, NUMSAT, HDOP, ALT, AUNIT, GSEP, GUNIT, AODC};
-	cases datamember= UTC;
-	char* start_ptr;
-	char* end_ptr = data_array+7;//Set start pointer after the message ID ("$GPGGA,")
-	bool flag=1;
-	char COORDbuf[14]={0};
-	char checksum[3]={0};
+	NMEA mode;
+	int c;
 
-	while (flag)
-	{
-		start_ptr = end_ptr;
-		
-		while (*end_ptr!=',' && (*(end_ptr+1)!=10)&& *end_ptr!='*')end_ptr++;//Increment ptr until a comma is found
-		
-		if (*end_ptr==10||*(end_ptr+1)==10||(*end_ptr=='*'&&*(end_ptr-1)==',')){//End reached
-			flag=0;
-			break;
-		}
-		
-		switch(datamember){
-				case UTC:
-					memcpy(GGAdata.UTC, start_ptr, (end_ptr - start_ptr));
-					GGAdata.UTC[end_ptr - start_ptr] = '\0';//End null char
-					datamember = LAT;
-					break;
-				case LAT:
-					memcpy(COORDbuf, start_ptr, (end_ptr - start_ptr));
-					if (*COORDbuf)
-					{
-						formatCOORDS(COORDbuf);
-						memcpy(GGAdata.LAT, COORDbuf, 13);
-						memset(COORDbuf, 0, 13);	
-					}
-					datamember=NS;
-					break;
-				case NS:
-					if (*start_ptr!=','){
-						GGAdata.NS = *start_ptr;
-						strncat(GGAdata.LAT, start_ptr, 1);
-					}
-					datamember=LONG;
-					break;
-				case LONG:
-					memcpy(COORDbuf, start_ptr, (end_ptr - start_ptr ));
-					if (*COORDbuf){
-						formatCOORDS(COORDbuf);
-						memcpy(GGAdata.LONG, COORDbuf, 14);
-					}
-					datamember=EW;
-					break;
-				case EW:
-					if (*start_ptr!=','){
-						GGAdata.EW = *start_ptr;
-						strncat(GGAdata.LONG, start_ptr, 1);
-					}
-					datamember=PFI;
-					break;
-				case PFI:
-					if (*start_ptr!=',')GGAdata.PFI = *start_ptr;
-					datamember=NUMSAT;
-					break;
-				case NUMSAT:
-					memcpy(GGAdata.NUMSAT, start_ptr, (end_ptr - start_ptr));
-					GGAdata.NUMSAT[end_ptr - start_ptr] = '\0';
-					datamember=HDOP;
-					break;
-				case HDOP:
-					memcpy(GGAdata.HDOP, start_ptr, (end_ptr - start_ptr));
-					GGAdata.HDOP[end_ptr - start_ptr] = '\0';
-					datamember=ALT;
-					break;
-				case ALT:
-					memcpy(GGAdata.ALT, start_ptr, (end_ptr - start_ptr));
-					GGAdata.ALT[end_ptr - start_ptr] = '\0';
-					datamember=AUNIT;
-					break;
-				case AUNIT:
-					if (*start_ptr!=',')GGAdata.AUNIT= *start_ptr;
-					datamember=GSEP;
-					break;
-				case GSEP:
-					memcpy(GGAdata.GSEP, start_ptr, (end_ptr - start_ptr));
-					GGAdata.GSEP[end_ptr - start_ptr] = '\0';
-					datamember=GUNIT;
-					break;
-				case GUNIT:
-					if (*start_ptr!=',')GGAdata.GUNIT=*start_ptr;
-					datamember=AODC;
-					break;
-				case AODC:
-					memcpy(GGAdata.AODC, start_ptr, (end_ptr - start_ptr));
-					GGAdata.AODC[end_ptr - start_ptr] = '\0';
-					flag=0;
-					break;
+#if GPS_USE_PPS
+	uint8_t at;
 
-					}
-			end_ptr++;//Increment past the last comma
+	for (at = rxRing.getTail(); (c = rxRing.pop()) >= 0; at = rxRing.getTail()){
+		mode = feed(c);
+		if (c == '$'){//feed() took the time it was parsed, use the time it arrived
+			sentenceMicros = sentenceArrival(at, sentenceMicros);
+		}
+#else
+	while ((c = rxRing.pop()) >= 0){
+		mode = feed(c);
+#endif
+		if (mode != INVALID){
+			return mode;
+		}
 	}
-	//Get checksum
-	while(*(end_ptr)!=10)end_ptr++;
-		checksum[0] = *(end_ptr - 3);
-		checksum[1] = *(end_ptr - 2);
-		checksum[2] = NULL;
-	memcpy(GGAdata.CHECKSUM, checksum, 3);
-	return;
+	return INVALID;
 }
 
 /* ------------------------------------------------------------ */
-/*  formatGSA()
+/*  processAvailable()
 **
 **  Parameters:
-**	  data: an array to the data to be formatted
-**	  GSAdata: a pointer to the GSA_DATA structure to store the parsed data in
+**	  maxSentences: The most sentences to parse in this call
 **
 **  Return Value:
-**    none
+**    NMEA_BIT() of each sentence type that was updated, with
+**	  EPOCH_COMPLETE set if an epoch was completed during the call
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Formats a mode's data into elements in a struct.
-*/
-void GPS::formatGSA(char* data_array)
-{
-	enum cases {MODE1, MODE2, SAT1, SAT2, SAT3, SAT4, SAT5, SAT6, SAT7, SAT8, SAT9, SAT10, SAT11, SAT12, PDOP, HDOP, VDOP, AODC};
-	cases datamember=MODE1;
-	char* start_ptr;
-	char* end_ptr = data_array+7;//Set start pointer after the message ID ("$GPGGA,")
-	bool flag=1;
-	char COORDbuf[14]={0};
-	char checksum[3]={0};
-	
-	while (flag)
-	{
-		start_ptr = end_ptr;
-		
-		while (*end_ptr!=',' && (*(end_ptr+1)!=10)&& *end_ptr!='*')end_ptr++;//Increment ptr until a comma is found
-		if (*end_ptr==10||*(end_ptr+1)==10||(*end_ptr=='*'&&*(end_ptr-1)==',')){//End reached
-			flag=0;
-			break;
-		}
-		switch(datamember){
-		
-		    
-			case MODE1:
-				if (*start_ptr!=',')GSAdata.MODE1 = *start_ptr;
-				datamember = MODE2;
-				break;
-			case MODE2:
-				if (*start_ptr!=',')GSAdata.MODE2 = *start_ptr;
-				datamember=SAT1;
-				break;
-			case SAT1:
-				memcpy(GSAdata.SAT1, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT1[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT2;
-				break;
-			case SAT2:
-				memcpy(GSAdata.SAT2, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT2[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT3;
-				break;
-			case SAT3:
-				memcpy(GSAdata.SAT3, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT3[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT4;
-				break;
-			case SAT4:
-				memcpy(GSAdata.SAT4, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT4[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT5;
-				break;
-			case SAT5:
-				memcpy(GSAdata.SAT5, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT5[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT6;
-				break;
-			case SAT6:
-				memcpy(GSAdata.SAT6, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT6[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT7;
-				break;
-			case SAT7:
-				memcpy(GSAdata.SAT7, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT7[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT8;
-				break;
-			case SAT8:
-				memcpy(GSAdata.SAT8, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT8[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT9;
-				break;
-			case SAT9:
-				memcpy(GSAdata.SAT9, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT9[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT10;
-				break;
-			case SAT10:
-				memcpy(GSAdata.SAT10, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT10[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT11;
-				break;
-			case SAT11:
-				memcpy(GSAdata.SAT11, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT11[end_ptr - start_ptr] = '\0';//End null char
-				datamember=SAT12;
-				break;
-			case SAT12:
-				memcpy(GSAdata.SAT12, start_ptr, (end_ptr - start_ptr));
-				GSAdata.SAT12[end_ptr - start_ptr] = '\0';//End null char
-				datamember=PDOP;
-				break;
-			case PDOP:
-				memcpy(GSAdata.PDOP, start_ptr, (end_ptr - start_ptr));
-				GSAdata.PDOP[end_ptr - start_ptr] = '\0';//End null char
-				datamember=HDOP;
-				break;
-			case HDOP:
-				memcpy(GSAdata.HDOP, start_ptr, (end_ptr - start_ptr));
-				GSAdata.HDOP[end_ptr - start_ptr] = '\0';//End null char
-				datamember=VDOP;
-				break;
-			case VDOP:
-				memcpy(GSAdata.VDOP, start_ptr, (end_ptr - start_ptr));
-				GSAdata.VDOP[end_ptr - start_ptr] = '\0';//End null char
-				flag=0;
-				break;
-				}
-		end_ptr++;//Increment past the last comma
+**    Parses every complete sentence already in the receive ring,
+**	  up to maxSentences, instead of one per call like getData(),
+**	  then moves on any PMTK command being sent, see updateCommand().
+**	  Call ingest() first if the port is not drained elsewhere.
+*/
+uint16_t GPS::processAvailable(uint8_t maxSentences)
+{
+	uint16_t updated = 0;
+	uint8_t count = 0;
+	NMEA mode;
 
-	} //end of while 
-	//Get checksum
-	while(*(end_ptr)!=10)end_ptr++;
-		checksum[0] = *(end_ptr - 3);
-		checksum[1] = *(end_ptr - 2);
-		checksum[2] = NULL;
-	memcpy(GSAdata.CHECKSUM, checksum, 3);
-	return;
+	while (count < maxSentences && (mode = poll()) != INVALID){
+		updated |= NMEA_BIT(mode);
+		count++;
+	}
+	if (epochDone){
+		updated |= EPOCH_COMPLETE;
+		epochDone = false;
+	}
+#if GPS_USE_ACK
+	updateCommand();
+#endif
+	return updated;
 }
 
 /* ------------------------------------------------------------ */
-/*  formatGSV()
+/*  setEpochSentences(), isEpochComplete()
 **
 **  Parameters:
-**	  data: an array to the data to be formatted
-**	  GSVdata: a pointer to the GSV_DATA structure to store the parsed data in
+**	  mask: NMEA_BIT()s of the sentences the PmodGPS sends each fix
 **
 **  Return Value:
-**    none
+**    isEpochComplete(): true once every sentence in mask has
+**		arrived for the current fix
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Formats GSV messages into their corresponding structs.
-*/
-void GPS::formatGSV(char* data_array)
-{
-enum cases {NUMM, MESNUM, SATVIEW, SATID1, ELV1, AZM1, SNR1, SATID2, ELV2, AZM2, SNR2, SATID3, ELV3, AZM3, SNR3, SATID4, ELV4, AZM4, SNR4};
-	cases datamember=NUMM;
-	char* start_ptr;
-	char* end_ptr = data_array+7;//Set start pointer after the message ID ("$GPGGA,")
-	bool flag=1;
-	char checksum[3]={0};
-	int mesnum = 0;
-	char buffer[4];
-	
-	while (flag)
-	{
-		start_ptr = end_ptr;
-		
-		while (*end_ptr!=',' && (*(end_ptr+1)!=10)&& *(end_ptr)!='*')end_ptr++;//Increment ptr until a comma is found
-		
-		if (*end_ptr==10||*(end_ptr+1)==10||(*end_ptr=='*'&&*(end_ptr-1)==',')){//End reached
-			flag=0;
-			break;
-		}
-		switch(datamember){
-			case NUMM:
-				if (*start_ptr!=',')GSVdata.NUMM = (int)(*start_ptr-'0');
-				datamember = MESNUM;
-				break;
-			case MESNUM:
-				if (*start_ptr!=','){
-					GSVdata.MESNUM = (int)(*start_ptr-'0');
-					mesnum=GSVdata.MESNUM;
-					}
-				datamember=SATVIEW;
-				break;
-			case SATVIEW:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SATVIEW=atoi(buffer);
-				datamember=SATID1;
-				break;
-			case SATID1:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4].ID=atoi(buffer);
-				datamember=ELV1;
-				break;
-			case ELV1:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4].ELV=atoi(buffer);
-				datamember=AZM1;
-				break;
-			case AZM1:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4].AZM=atoi(buffer);
-				datamember=SNR1;
-				break;
-			case SNR1:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4].SNR=atoi(buffer);
-				datamember=SATID2;
-				break;
-			case SATID2:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+1].ID=atoi(buffer);
-				datamember=ELV2;
-				break;
-			case ELV2:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+1].ELV=atoi(buffer);
-				datamember=AZM2;
-				break;
-			case AZM2:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+1].AZM=atoi(buffer);
-				datamember=SNR2;
-				break;
-			case SNR2:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+1].SNR=atoi(buffer);
-				datamember=SATID3;
-				break;
-			case SATID3:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+2].ID=atoi(buffer);
-				datamember=ELV3;
-				break;
-			case ELV3:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+2].ELV=atoi(buffer);
-				datamember=AZM3;
-				break;
-			case AZM3:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+2].AZM=atoi(buffer);
-				datamember=SNR3;
-				break;
-			case SNR3:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+2].SNR=atoi(buffer);
-				datamember=SATID4;
-				break;
-			case SATID4:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+3].ID=atoi(buffer);
-				datamember=ELV4;
-				break;
-			case ELV4:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+3].ELV=atoi(buffer);
-				datamember=AZM4;
-				break;
-			case AZM4:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+3].AZM=atoi(buffer);
-				datamember=SNR4;
-				break;
-			case SNR4:
-				memcpy(buffer, start_ptr, (end_ptr - start_ptr));
-				buffer[end_ptr - start_ptr] = '\0';//End null char
-				GSVdata.SAT[(mesnum-1)*4+3].SNR=atoi(buffer);
-				flag=0;
-				break;
-				}
-		end_ptr++;
-	} //end of while 
-	
-	//Get checksum
-	while(*(end_ptr)!=10)end_ptr++;
-		checksum[0] = *(end_ptr - 3);
-		checksum[1] = *(end_ptr - 2);
-		checksum[2] = NULL;
-	memcpy(GSVdata.CHECKSUM, checksum, 3);
-	//Serial.print("CHECKSUM: ");Serial.println(GSVdata.CHECKSUM);
-	return;
+**    An epoch is the group of sentences sent for one fix, all
+**	  sharing the UTC time of its GGA or RMC. The default is those of
+**	  the five sentence types the PmodGPS sends by default that
+**	  PmodGPSConfig.h builds. Change it if the PmodGPS is set to send
+**	  fewer. Sentences that are not built never arrive, so they are
+**	  taken out of mask.
+*/
+void GPS::setEpochSentences(uint16_t mask)
+{
+	epochRequired = mask & EPOCH_BUILT;
+}
+
+bool GPS::isEpochComplete()
+{
+	return (epochMask & epochRequired) == epochRequired;
 }
 
 /* ------------------------------------------------------------ */
-/*  formatRMC()
+/*  feed()
 **
 **  Parameters:
-**	  data: an array to the data to be formatted
-**	  RMCdata: a pointer to the RMC_DATA structure to store the parsed data in
+**	  c: The next byte received from the PmodGPS
 **
 **  Return Value:
-**    none
+**    The type of sentence completed by this byte, INVALID while a
+**	  sentence is still in progress or if it was not recognized.
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Formats a mode's data into elements in a struct.
-*/
-void GPS::formatRMC(char* data_array)
-{
-	enum cases {UTC, STAT, LAT, NS, LONG,EW, SOG, COG, DATE, MVAR, MVARDIR, MODE};
-	cases datamember= UTC;
-	char* start_ptr;
-	char* end_ptr = data_array+7;//Set start pointer after the message ID ("$GPGGA,")
-	bool flag=1;
-	char COORDbuf[14]={0};
-	char checksum[3]={0};
-	
-	while (flag)
-	{
-		start_ptr = end_ptr;
-		
-		while (*end_ptr!=',' && (*(end_ptr+1)!=10)&& *end_ptr!='*')end_ptr++;//Increment ptr until a comma is found
-		
-		if (*end_ptr==10||*(end_ptr+1)==10||(*end_ptr=='*'&&*(end_ptr-1)==',')){//End reached
-			flag=0;
-			break;
+**    Incremental sentence parser. A '$' starts a new sentence and
+**	  bytes are collected until the decimal 10 (ASCII <LF>) ending it,
+**	  partial sentences are kept between calls. The XOR checksum is
+**	  built up as the bytes arrive and compared with the two hex
+**	  digits after the '*' once the sentence is complete, only then
+**	  is it checked by chooseMode() and formatted into its struct.
+**	  Bytes outside of a sentence are dropped. Sentences that fail the
+**	  checksum are counted as rejected, ones that are cut short by a
+**	  new '$', longer than MAX_SIZE or missing the checksum are counted
+**	  as truncated. Neither changes any of the data structs.
+*/
+NMEA GPS::feed(uint8_t c)
+{
+	NMEA mode = INVALID;
+	NMEA_FIELD fields[MAX_FIELDS];
+	NMEA_FIELD checksum;
+	uint8_t numFields;
+	uint8_t received;
+
+	if (c == '$'){//Start of a sentence, drop any unfinished one
+		if (sentenceLen){
+			countTruncated();
 		}
-		switch(datamember){
-			case UTC:
-				memcpy(RMCdata.UTC, start_ptr, (end_ptr - start_ptr));
-				RMCdata.UTC[end_ptr - start_ptr] = '\0';//End null char
-				datamember = STAT;
-				break;
-			case STAT:
-				if (*start_ptr!=',')RMCdata.STAT = *start_ptr;
-				datamember=LAT;
-				break;
-			case LAT:
-				memcpy(RMCdata.LAT, start_ptr, (end_ptr - start_ptr));
-				RMCdata.LAT[end_ptr - start_ptr] = '\0';//End null char
-				datamember=NS;
-				break;
-			case NS:
-				if (*start_ptr!=',')RMCdata.NS = *start_ptr;
-				datamember=LONG;
-				break;
-			case LONG:
-				memcpy(RMCdata.LONG, start_ptr, (end_ptr - start_ptr));
-				RMCdata.LONG[end_ptr - start_ptr] = '\0';//End null char
-				datamember=EW;
-				break;
-			case EW:
-				if (*start_ptr!=',')RMCdata.EW = *start_ptr;
-				datamember=SOG;
-				break;
-			case SOG:
-				memcpy(RMCdata.SOG, start_ptr, (end_ptr - start_ptr));
-				RMCdata.SOG[end_ptr - start_ptr] = '\0';//End null char
-				datamember=COG;
+#if GPS_USE_PPS
+		sentenceMicros = micros();
+#endif
+		sentenceLen = 0;
+		checksumCalc = 0;
+		checksumPos = 0;
+	}
+	else if (sentenceLen == 0){//Not inside a sentence
+		return INVALID;
+	}
+	else if (checksumPos == 0){//Checksum covers the bytes between '$' and '*'
+		if (c == '*'){
+			checksumPos = sentenceLen;
+		}
+		else{
+			checksumCalc ^= c;
+		}
+	}
+
+	if (sentenceLen >= MAX_SIZE - 1){//No room left for the null char
+		countTruncated();
+		sentenceLen = 0;
+		return INVALID;
+	}
+	sentence[sentenceLen++] = c;
+
+	if (c != 10){//Sentence not finished yet
+		return INVALID;
+	}
+	sentence[sentenceLen] = '\0';
+
+	//Need at least "$GPxxx," before the sentence type can be decided
+	if (sentenceLen > 7){
+		mode = chooseMode(sentence);
+	}
+
+	//Two hex digits must follow the '*', before the <CR><LF>
+	if (checksumPos == 0 || checksumPos + 3 >= sentenceLen){
+		countTruncated();
+		sentenceLen = 0;
+		return INVALID;
+	}
+	sentenceLen = 0;
+	received = (hexValue(sentence[checksumPos + 1]) << 4) | hexValue(sentence[checksumPos + 2]);
+	if (received != checksumCalc || hexValue(sentence[checksumPos + 1]) > 15 || hexValue(sentence[checksumPos + 2]) > 15){
+		stats[mode].rejected++;
+		return INVALID;
+	}
+	stats[mode].accepted++;
+
+	//Debugging purposes
+	//Serial.print("\n\n Message received: ");Serial.println(sentence); //This is the full sentence sent from the PmodGPS
+
+	if (mode == INVALID){
+		return INVALID;
+	}
+
+	//Split the sentence into fields once, then format them into structs
+	numFields = tokenize(sentence, fields, &checksum);
+	talker = TALKER(sentence[1], sentence[2]);
+	switch(mode){
+#if GPS_USE_GGA
+		case(GGA):formatGGA(sentence, fields, numFields);
+			KEEP_CHECKSUM(GGAdata);
+			break;
+#endif
+#if GPS_USE_GSA
+		case(GSA):formatGSA(sentence, fields, numFields);
+			KEEP_CHECKSUM(GSAdata);
+			break;
+#endif
+#if GPS_USE_GSV
+		case(GSV):formatGSV(sentence, fields, numFields);
+			KEEP_CHECKSUM(GSVdata);
+			break;
+#endif
+#if GPS_USE_RMC
+		case(RMC):formatRMC(sentence, fields, numFields);
+			KEEP_CHECKSUM(RMCdata);
+			break;
+#endif
+#if GPS_USE_VTG
+		case(VTG):formatVTG(sentence, fields, numFields);
+			KEEP_CHECKSUM(VTGdata);
+			break;
+#endif
+#if GPS_USE_GLL
+		case(GLL):formatGLL(sentence, fields, numFields);
+			KEEP_CHECKSUM(GLLdata);
+			break;
+#endif
+#if GPS_USE_ZDA
+		case(ZDA):formatZDA(sentence, fields, numFields);
+			KEEP_CHECKSUM(ZDAdata);
+			break;
+#endif
+#if GPS_USE_TXT
+		case(TXT):formatTXT(sentence, fields, numFields);
+			KEEP_CHECKSUM(TXTdata);
+			break;
+#endif
+#if GPS_USE_ACK
+		case(PMTK_ACK):formatAck(sentence, fields, numFields);
+			KEEP_CHECKSUM(ACKdata);
+			break;
+#endif
+		default://Types left out by PmodGPSConfig.h never get here
+			break;
+	}
+	if (mode != GSV || gsvDone){
+		sequence[mode]++;
+	}
+	updateEpoch(mode);
+
+	return(mode);//Return the type of sentence that was sent
+}
+
+/* ------------------------------------------------------------ */
+/* 	getGGA(), getGSA(), getGSV(), getRMC(), getVTG(), getGLL(), getZDA(),
+**	getTXT(), getAck()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    The struct containing the data from the $--XXX sentence
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Get functions for the private structs in the PmodGPS class.
+**		They return a reference, so nothing is copied unless the
+**		caller keeps a copy. The struct changes when the next
+**		sentence of its type is parsed. Only built with
+**		GPS_USE_STRINGS and the sentence's GPS_USE_ setting.
+*/
+#if GPS_USE_STRINGS
+#if GPS_USE_GGA
+const GGA_DATA& GPS::getGGA()
+{
+	return GGAdata;
+}
+#endif
+#if GPS_USE_GSA
+const GSA_DATA& GPS::getGSA()
+{
+	return GSAdata;
+}
+#endif
+#if GPS_USE_GSV
+const GSV_DATA& GPS::getGSV()
+{
+	return GSVdata;
+}
+#endif
+#if GPS_USE_RMC
+const RMC_DATA& GPS::getRMC()
+{
+	return RMCdata;
+}
+#endif
+#if GPS_USE_VTG
+const VTG_DATA& GPS::getVTG()
+{
+	return VTGdata;
+}
+#endif
+#if GPS_USE_GLL
+const GLL_DATA& GPS::getGLL()
+{
+	return GLLdata;
+}
+#endif
+#if GPS_USE_ZDA
+const ZDA_DATA& GPS::getZDA()
+{
+	return ZDAdata;
+}
+#endif
+#if GPS_USE_TXT
+const TXT_DATA& GPS::getTXT()
+{
+	return TXTdata;
+}
+#endif
+#if GPS_USE_ACK
+const ACK_DATA& GPS::getAck()
+{
+	return ACKdata;
+}
+#endif
+#endif //GPS_USE_STRINGS
+
+/* ------------------------------------------------------------ */
+/* 	getTalker()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    TALKER() of the last sentence formatted, such as
+**	  TALKER('G','P') for GPS or TALKER('G','N') for a combined
+**	  multi-constellation solution. TALKER('P','M') for $PMTK.
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Tells which constellation the data just formatted came from.
+*/
+uint16_t GPS::getTalker()
+{
+	return talker;
+}
+
+/* ------------------------------------------------------------ */
+/* 	getSequence(), changedSince()
+**
+**  Parameters:
+**	  type: the sentence type
+**	  seen: the sequence number the caller last read, updated to
+**			the current one
+**
+**  Return Value:
+**    The number of sentences of the type formatted so far, wrapping
+**	  at 65535. A GSV series counts once, when its last part arrives.
+**	  changedSince() returns true if any arrived since seen.
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Lets any number of readers poll for new data without copying
+**		the structs, each keeping its own seen value.
+*/
+uint16_t GPS::getSequence(NMEA type)
+{
+	return sequence[type];
+}
+
+bool GPS::changedSince(NMEA type, uint16_t* seen)
+{
+	if (*seen == sequence[type]){
+		return false;
+	}
+	*seen = sequence[type];
+	return true;
+}
+
+#if GPS_USE_ACK
+/* ------------------------------------------------------------ */
+/*  sendCommand()
+**
+**  Parameters:
+**	  number: the PMTK command number, 220 for $PMTK220
+**	  args: the comma separated fields after the number, without a
+**			leading comma, NULL or "" if there are none
+**
+**  Return Value:
+**    true if the command was accepted for sending
+**
+**  Errors:
+**    Returns false without sending if GPSinit() has not been called,
+**	  the previous command is still being sent or waiting for its
+**	  acknowledgement, or the sentence would not fit in PMTK_MAX.
+**
+**  Description:
+**    Builds "$PMTKnnn,args*hh<CR><LF>" with its checksum and starts
+**	  writing it to the port. Only what fits in the port's transmit
+**	  buffer is written now, updateCommand() writes the rest, matches
+**	  the $PMTK001 the parser receives and sends the command again if
+**	  none arrives within PMTK_TIMEOUT ms. Poll getCommandState()
+**	  until it is CMD_DONE, CMD_FAILED or CMD_TIMEOUT.
+*/
+bool GPS::sendCommand(uint16_t number, const char* args)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+	size_t argsLen = args ? strlen(args) : 0;
+	uint8_t checksum = 0;
+	uint8_t len = 0;
+	uint8_t i;
+
+	if (port == NULL || commandState == CMD_SENDING || commandState == CMD_WAITING){
+		return false;
+	}
+	if (argsLen + 16 > PMTK_MAX){//$PMTKnnn, *hh<CR><LF> and the null
+		return false;
+	}
+	number %= 1000;
+	command[len++] = '$';
+	command[len++] = 'P';
+	command[len++] = 'M';
+	command[len++] = 'T';
+	command[len++] = 'K';
+	command[len++] = '0' + number / 100;
+	command[len++] = '0' + number / 10 % 10;
+	command[len++] = '0' + number % 10;
+	if (argsLen){
+		command[len++] = ',';
+		memcpy(command + len, args, argsLen);
+		len += argsLen;
+	}
+	for (i = 1; i < len; i++){//Checksum covers the bytes between '$' and '*'
+		checksum ^= command[i];
+	}
+	command[len++] = '*';
+	command[len++] = hexDigits[checksum >> 4];
+	command[len++] = hexDigits[checksum & 0x0F];
+	command[len++] = 13;
+	command[len++] = 10;
+	command[len] = '\0';
+
+	commandLen = len;
+	commandSent = 0;
+	commandNumber = number;
+	commandTries = 1;
+	commandFlag = 0;
+	commandState = CMD_SENDING;
+	updateCommand();
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  updateCommand()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    The CMD_STATE of the last command
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Writes as much of the command as the port's transmit buffer
+**	  has room for and handles the acknowledgement timeout, never
+**	  waits. processAvailable() calls it, call it from loop() if
+**	  getData() or poll() is used instead.
+*/
+CMD_STATE GPS::updateCommand()
+{
+	int room;
+
+	if (commandState == CMD_WAITING && millis() - commandTime >= PMTK_TIMEOUT){
+		if (commandTries < PMTK_RETRIES){
+			commandTries++;
+			commandSent = 0;
+			commandState = CMD_SENDING;
+		}
+		else{
+			commandState = CMD_TIMEOUT;
+		}
+	}
+	if (commandState == CMD_SENDING){
+		room = port->availableForWrite();
+		if (room > commandLen - commandSent){
+			room = commandLen - commandSent;
+		}
+		if (room > 0){
+			commandSent += port->write((const uint8_t*)command + commandSent, room);
+		}
+		if (commandSent >= commandLen){
+			commandState = CMD_WAITING;
+			commandTime = millis();
+		}
+	}
+	return (CMD_STATE)commandState;
+}
+
+/* ------------------------------------------------------------ */
+/*  getCommandState(), getCommandFlag()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    getCommandState(): the CMD_STATE of the last command
+**	  getCommandFlag(): the FLAG of its $PMTK001, '0' invalid command,
+**		'1' unsupported, '2' action failed, '3' succeeded. 0 until
+**		the acknowledgement arrives.
+**
+**  Errors:
+**    none
+*/
+CMD_STATE GPS::getCommandState()
+{
+	return (CMD_STATE)commandState;
+}
+
+uint8_t GPS::getCommandFlag()
+{
+	return commandFlag;
+}
+
+/* ------------------------------------------------------------ */
+/*  setUpdateRate()
+**
+**  Parameters:
+**	  ms: milliseconds between fixes, 100 (10 Hz) to 10000
+**
+**  Return Value:
+**    false if ms is out of range or sendCommand() refused it
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Sends $PMTK220. Every sentence is sent once per fix, so faster
+**	  rates need fewer sentences or a faster port: GGA and RMC take
+**	  about 150 bytes a fix, at 9600 baud (960 bytes a second) that
+**	  allows 5 Hz, 10 Hz needs 19200 baud or more. See setSentences()
+**	  and setBaudrate().
+*/
+bool GPS::setUpdateRate(uint16_t ms)
+{
+	char args[6];
+
+	if (ms < 100 || ms > 10000){
+		return false;
+	}
+	return sendCommand(220, formatFixed(args, sizeof(args), ms, 0));
+}
+
+/* ------------------------------------------------------------ */
+/*  setSentences()
+**
+**  Parameters:
+**	  mask: NMEA_BIT()s of the sentences to send each fix, of GLL,
+**			RMC, VTG, GGA, GSA, GSV and ZDA
+**
+**  Return Value:
+**    false if sendCommand() refused it
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Sends $PMTK314 with each sentence in mask sent every fix and
+**	  the others turned off, and sets the epoch to the same sentences
+**	  so isEpochComplete() keeps working. Sentences left out of
+**	  PmodGPSConfig.h are still sent if they are in mask, but are not
+**	  part of the epoch.
+*/
+bool GPS::setSentences(uint16_t mask)
+{
+	static const uint8_t order[] PROGMEM = {GLL, RMC, VTG, GGA, GSA, GSV};	//Fields 0 to 5 of $PMTK314, field 17 is ZDA
+	char args[38];	//19 single digit fields
+	uint8_t field;
+	uint8_t on;
+
+	for (field = 0; field < 19; field++){
+		if (field < sizeof(order)){
+			on = (mask & NMEA_BIT(pgm_read_byte(&order[field]))) != 0;
+		}
+		else{
+			on = (field == 17 && (mask & NMEA_BIT(ZDA)));
+		}
+		args[2 * field] = on ? '1' : '0';
+		args[2 * field + 1] = ',';
+	}
+	args[sizeof(args) - 1] = '\0';
+	if (!sendCommand(314, args)){
+		return false;
+	}
+	setEpochSentences(mask);
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  setBaudrate()
+**
+**  Parameters:
+**	  baud: 4800, 9600, 14400, 19200, 38400, 57600 or 115200
+**
+**  Return Value:
+**    false if sendCommand() refused it
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Sends $PMTK251. The PmodGPS changes speed as soon as it has the
+**	  command, so it is only sent once and its acknowledgement, if
+**	  any, is sent at the new speed. Once getCommandState() is no
+**	  longer CMD_SENDING, call begin(baud) on the port.
+*/
+bool GPS::setBaudrate(unsigned long baud)
+{
+	char args[8];
+
+	if (!sendCommand(251, formatFixed(args, sizeof(args), (int32_t)baud, 0))){
+		return false;
+	}
+	commandTries = PMTK_RETRIES;
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  putDateTime()
+**
+**  Parameters:
+**	  p: where to write, DATE_TIME_SIZE characters with the null
+**	  day, month, year: UTC date, year since 2000
+**	  utc: UTC time, ms since midnight
+**
+**  Return Value:
+**    p, holding "YYYY,MM,DD,hh,mm,ss" as $PMTK740 and $PMTK741 take it
+*/
+#define DATE_TIME_SIZE  20
+
+static char* putDateTime(char* p, uint8_t day, uint8_t month, uint8_t year, uint32_t utc)
+{
+	uint32_t seconds = utc / 1000 % 86400UL;
+	uint8_t values[6];
+	uint8_t len = 0;
+	uint8_t i;
+
+	values[0] = 20;
+	values[1] = year % 100;
+	values[2] = month;
+	values[3] = day;
+	values[4] = seconds / 3600;
+	values[5] = seconds / 60 % 60;
+	for (i = 0; i < 6; i++){
+		if (i > 1){
+			p[len++] = ',';
+		}
+		p[len++] = '0' + values[i] / 10 % 10;
+		p[len++] = '0' + values[i] % 10;
+	}
+	p[len++] = ',';
+	p[len++] = '0' + seconds % 60 / 10;
+	p[len++] = '0' + seconds % 10;
+	p[len] = '\0';
+	return p;
+}
+
+/* ------------------------------------------------------------ */
+/*  setReferenceTime(), setReferenceLocation()
+**
+**  Parameters:
+**	  lat, lon: position in 1e-7 degrees, as in FIX
+**	  altCm: altitude in cm, as in FIX
+**	  day, month, year: the UTC date now, year since 2000
+**	  utc: the UTC time now, ms since midnight
+**
+**  Return Value:
+**    false if the arguments did not fit or sendCommand() refused it
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Send $PMTK740 (time) or $PMTK741 (position and time) to aid the
+**	  next fix after the PmodGPS has lost its backup power. The time
+**	  must be the time now, to within a few seconds, not the time the
+**	  position was saved; a wrong time makes the start slower than a
+**	  cold start. The position helps if it is within a few km.
+*/
+bool GPS::setReferenceTime(uint8_t day, uint8_t month, uint8_t year, uint32_t utc)
+{
+	char args[DATE_TIME_SIZE];
+
+	return sendCommand(740, putDateTime(args, day, month, year, utc));
+}
+
+bool GPS::setReferenceLocation(int32_t lat, int32_t lon, int32_t altCm, uint8_t day, uint8_t month, uint8_t year, uint32_t utc)
+{
+	char args[PMTK_MAX - 16];
+	int32_t values[3] = {lat, lon, altCm / 100 + (altCm % 100 >= 50) - (altCm % 100 <= -50)};
+	uint8_t len = 0;
+	uint8_t field;
+	uint8_t i;
+
+	for (i = 0; i < 3; i++){
+		if (i < 2){
+			formatDegrees(args + len, sizeof(args) - len, values[i], 6);
+		}
+		else{
+			formatFixed(args + len, sizeof(args) - len, values[i], 0);
+		}
+		field = strlen(args + len);
+		if (field == 0 || field + 1u >= sizeof(args) - len){//Empty if it did not fit
+			return false;
+		}
+		len += field;
+		args[len++] = ',';
+	}
+	if (sizeof(args) - len < DATE_TIME_SIZE){
+		return false;
+	}
+	putDateTime(args + len, day, month, year, utc);
+	return sendCommand(741, args);
+}
+#endif
+
+
+/* ------------------------------------------------------------ */
+/*  isFixed()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    bool PFI
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Returns a true if PFI is 1, else 0. With attachFixPin() the 3DF
+**	  pin is used instead whenever it tells, see getPinFix(), so a
+**	  lost fix shows within DF_DEBOUNCE ms instead of at the next GGA.
+*/
+bool GPS::isFixed(){
+#if GPS_USE_DF
+	PIN_FIX pin = getPinFix();
+
+	if (pin != PIN_UNKNOWN){
+		return pin == PIN_FIXED;
+	}
+#endif
+	if (fix.PFI==1)
+	{
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+
+/* ------------------------------------------------------------ */
+/*  getLatitude(), getLongitude()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    A string containing the data requested
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Get functions for several data members in string form
+*/
+#if GPS_USE_STRINGS && GPS_USE_GGA
+char* GPS::getLatitude(){
+	return GGAdata.LAT;
+}
+
+char* GPS::getLongitude(){
+	return GGAdata.LONG;
+}
+#endif
+
+
+/* ------------------------------------------------------------ */
+/*  getAltitudeString(), getDate()
+**
+**  Parameters:
+**	  out: the buffer to write the text into
+**	  n: the size of out, 12 and 9 are enough
+**
+**  Return Value:
+**    out, holding the altitude with its unit ("39.90 m") or the date
+**	  as mm/dd/yy
+**
+**  Errors:
+**    out is set to an empty string if the text does not fit
+**
+**  Description:
+**    Formats the altitude or date of the fix into the caller's
+**		buffer, see GPSFormat.h. The date comes from RMC or ZDA.
+*/
+char* GPS::getAltitudeString(char* out, size_t n){
+	return formatAltitude(out, n, fix.ALT);
+}
+
+char* GPS::getDate(char* out, size_t n){
+	return formatDate(out, n, fix.DAY, fix.MONTH, fix.YEAR);
+}
+
+/* ------------------------------------------------------------ */
+/*  getTime(), getNumSats(), getPDOP(), getAltitude(), getSpeedKnots(),
+**		getSpeedKM(), getHeading()
+**
+**  Parameters:
+**	  	none
+**
+**  Return Value:
+**    The data in the structs in either integer or double form
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Get functions for several items in the PmodGPS structs. These
+**		values are read from the numeric fix filled in while the
+**		sentences were parsed. getTime() returns hhmmss.sss.
+*/
+double GPS::getTime(){
+	uint32_t seconds = fix.UTC / 1000;
+
+	return (seconds / 3600) * 10000.0 + ((seconds / 60) % 60) * 100.0 + (seconds % 60) + (fix.UTC % 1000) / 1000.0;
+}
+
+int GPS::getNumSats(){
+	return fix.NUMSAT;
+}
+
+double GPS::getPDOP(){
+	return fix.PDOP / 100.0;
+}
+
+double GPS::getAltitude(){
+	return fix.ALT / 100.0;
+}
+
+double GPS::getSpeedKnots(){
+	return fix.SPEED / 514.444;//mm/s in one knot
+}
+
+double GPS::getSpeedKM(){
+	return fix.SPEED / 277.778;//mm/s in one km/h
+}
+
+double GPS::getHeading(){
+	return fix.COURSE / 100.0;
+}
+
+
+
+/* ------------------------------------------------------------ */
+/*  getSatelliteInfo(), getSky()
+**
+**  Parameters:
+**	 	none
+**
+**  Return Value:
+**    The SATELLITE structs of the published sky view, and the view
+**	  itself with the number of satellites in it
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    A get function for the satellite info. The view only changes
+**		when the last part of a GSV series arrives, so it always
+**		holds whole series, never some parts of one.
+*/
+#if GPS_USE_GSV
+const SATELLITE* GPS::getSatelliteInfo(){
+	return sky[skyFront].SAT;
+}
+
+const SKY_VIEW& GPS::getSky(){
+	return sky[skyFront];
+}
+#endif
+
+
+/* ------------------------------------------------------------ */
+/*  getFix()
+**
+**  Parameters:
+**	 	none
+**
+**  Return Value:
+**    The numeric form of the latest fix
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Position, altitude, speed, time and DOP values as integers,
+**		so they can be used without converting the strings again.
+*/
+const FIX& GPS::getFix(){
+	return fix;
+}
+
+/* ------------------------------------------------------------ */
+/*  getEpochFix(), getEpochSequence()
+**
+**  Parameters:
+**	 	none
+**
+**  Return Value:
+**    The fix as it was when the last epoch completed, and the number
+**		of epochs completed so far, wrapping at 65535
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    getFix() changes field by field as the sentences of an epoch
+**		arrive. The epoch fix only changes once every sentence set by
+**		setEpochSentences() has arrived, so its position, speed and
+**		DOP always come from the same epoch. Compare the sequence
+**		with the one last read to tell whether it changed.
+*/
+const FIX& GPS::getEpochFix(){
+	return epochFix;
+}
+
+uint16_t GPS::getEpochSequence(){
+	return epochSequence;
+}
+
+#if GPS_USE_DF
+static GPS* dfOwner = NULL;	//GPS the 3DF interrupt belongs to
+
+/* ------------------------------------------------------------ */
+/*  attachFixPin()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    true if the 3DF pin has an interrupt, false if it has to be
+**	  polled
+**
+**  Errors:
+**    Returns false and does nothing if GPSinit() has not been called.
+**
+**  Description:
+**    Starts following the fix from the PmodGPS's 3DF output. The pin
+**	  toggles every second while there is no fix and stays low once
+**	  there is one. Its edges are timed by a CHANGE interrupt, or by
+**	  pollFixPin() if the pin has none. Only one GPS can use the
+**	  interrupt, the last to call this.
+*/
+bool GPS::attachFixPin()
+{
+	int interrupt;
+
+	if (dfPin == GPS_NO_PIN){
+		return false;
+	}
+	noInterrupts();
+	dfLevel = digitalRead(dfPin);
+	dfStable = dfLevel;
+	dfEdgeMillis = millis();
+	dfToggleMillis = dfEdgeMillis;
+	dfSeen = false;
+	interrupts();
+	interrupt = digitalPinToInterrupt(dfPin);
+	if (interrupt == NOT_AN_INTERRUPT){
+		dfMode = 2;
+		return false;
+	}
+	dfOwner = this;
+	dfMode = 1;
+	attachInterrupt(interrupt, dfISR, CHANGE);
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  dfISR()
+**
+**  Description:
+**    Either edge of the 3DF pin.
+*/
+void IRAM_ATTR GPS::dfISR()
+{
+	dfOwner->dfEdge(digitalRead(dfOwner->dfPin), millis());
+}
+
+/* ------------------------------------------------------------ */
+/*  dfEdge(), dfSettle()
+**
+**  Parameters:
+**	  level: the level of the 3DF pin after an edge
+**	  now: millis() at the edge, or when dfSettle() is called
+**
+**  Description:
+**    A level only counts once it has held for DF_DEBOUNCE ms, so a
+**	  glitch that goes back is ignored. dfEdge() counts the level
+**	  that the edge ends, from dfISR() or pollFixPin(), so every
+**	  toggle is seen however seldom getPinFix() is called. dfSettle()
+**	  counts the level the pin is at now, with interrupts off.
+*/
+void IRAM_ATTR GPS::dfEdge(uint8_t level, uint32_t now)
+{
+	if (level == dfLevel){//An edge and its return in one, or no edge
+		return;
+	}
+	dfSettle(now);
+	dfLevel = level;
+	dfEdgeMillis = now;
+}
+
+void IRAM_ATTR GPS::dfSettle(uint32_t now)
+{
+	if (dfLevel != dfStable && now - dfEdgeMillis >= DF_DEBOUNCE){
+		dfStable = dfLevel;
+		dfToggleMillis = dfEdgeMillis;
+		dfSeen = true;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  pollFixPin()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Reads the 3DF pin when attachFixPin() could not give it an
+**	  interrupt, ingest() and getPinFix() call it.
+*/
+void GPS::pollFixPin()
+{
+	if (dfMode != 2){
+		return;
+	}
+	dfEdge(digitalRead(dfPin), millis());
+}
+
+/* ------------------------------------------------------------ */
+/*  getPinFix()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    PIN_NO_FIX within DF_FIX_TIME ms of the 3DF pin changing level,
+**	  PIN_FIXED once it has then stayed low for DF_FIX_TIME ms, and
+**	  PIN_UNKNOWN if it is not followed, has not toggled since
+**	  attachFixPin() or is stuck high
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Only levels that held for DF_DEBOUNCE ms count, see dfEdge().
+*/
+PIN_FIX GPS::getPinFix()
+{
+	uint32_t toggle;
+	uint32_t now;
+	uint8_t stable;
+	bool seen;
+
+	if (dfMode == 0){
+		return PIN_UNKNOWN;
+	}
+	pollFixPin();
+	noInterrupts();
+	now = millis();
+	dfSettle(now);
+	toggle = dfToggleMillis;
+	stable = dfStable;
+	seen = dfSeen;
+	interrupts();
+	if (!seen){
+		return PIN_UNKNOWN;
+	}
+	if (now - toggle < DF_FIX_TIME){
+		return PIN_NO_FIX;
+	}
+	return (stable == LOW) ? PIN_FIXED : PIN_UNKNOWN;
+}
+#endif
+
+#if GPS_USE_PPS
+static GPS* ppsOwner = NULL;	//GPS the 1PPS interrupt belongs to, ISRs cannot be members
+
+/* ------------------------------------------------------------ */
+/*  attachPPS()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    true if the 1PPS pin has an interrupt, false if it has to be
+**	  polled
+**
+**  Errors:
+**    Returns false and does nothing if GPSinit() has not been called.
+**
+**  Description:
+**    Starts timestamping fixes with the PmodGPS's 1PPS output, which
+**	  rises at the start of each UTC second while there is a fix. The
+**	  rising edge's micros() is captured by an interrupt, or by
+**	  pollPPS() if the pin has none, such as pin 7 on the Uno. Only
+**	  one GPS can use the interrupt, the last to call this.
+*/
+bool GPS::attachPPS()
+{
+	int interrupt;
+
+	if (ppsPin == GPS_NO_PIN){
+		return false;
+	}
+	ppsLevel = digitalRead(ppsPin);
+	interrupt = digitalPinToInterrupt(ppsPin);
+	if (interrupt == NOT_AN_INTERRUPT){
+		ppsMode = 2;
+		return false;
+	}
+	ppsOwner = this;
+	ppsMode = 1;
+	attachInterrupt(interrupt, ppsISR, RISING);
+	return true;
+}
+
+/* ------------------------------------------------------------ */
+/*  ppsISR()
+**
+**  Description:
+**    Rising edge of the 1PPS pin, only notes the time.
+*/
+void IRAM_ATTR GPS::ppsISR()
+{
+	ppsOwner->ppsMicros = micros();
+	ppsOwner->ppsCount++;
+}
+
+/* ------------------------------------------------------------ */
+/*  pollPPS()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Reads the 1PPS pin when attachPPS() could not give it an
+**	  interrupt, ingest() calls it. The pulse is 100 ms long, so it is
+**	  seen if this runs at least that often, but the timestamp is only
+**	  as close as the time between calls.
+*/
+void GPS::pollPPS()
+{
+	uint8_t level;
+
+	if (ppsMode != 2){
+		return;
+	}
+	level = digitalRead(ppsPin);
+	if (level == HIGH && ppsLevel == LOW){
+		ppsMicros = micros();
+		ppsCount++;
+	}
+	ppsLevel = level;
+}
+
+/* ------------------------------------------------------------ */
+/*  updateFixTime()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Called at the first sentence of each fix. A pulse that came in
+**	  the second before the sentence started its UTC second, and
+**	  fixes later in the same second (at 5 or 10 Hz) are timed from
+**	  it too. If there has been no pulse for the second the fix gets
+**	  the time its sentence was parsed instead.
+*/
+void GPS::updateFixTime()
+{
+	uint32_t pulseMicros;
+	uint16_t pulses;
+
+	noInterrupts();
+	pulseMicros = ppsMicros;
+	pulses = ppsCount;
+	interrupts();
+
+	if (pulses != ppsUsed && sentenceMicros - pulseMicros < 1000000UL){
+		ppsUsed = pulses;
+		ppsTied = true;
+		ppsUTC = fix.UTC - fix.UTC % 1000;
+		ppsLocal = pulseMicros;
+	}
+	fixTime.UTC = fix.UTC;
+	fixTime.PULSES = pulses;
+	if (ppsTied && fix.UTC >= ppsUTC && fix.UTC - ppsUTC < 1000){
+		fixTime.MICROS = ppsLocal + (fix.UTC - ppsUTC) * 1000;
+		fixTime.LATENCY = sentenceMicros - fixTime.MICROS;
+		fixTime.PPS = true;
+	}
+	else{
+		fixTime.MICROS = sentenceMicros;
+		fixTime.LATENCY = 0;
+		fixTime.PPS = false;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  stampSentence(), sentenceArrival()
+**
+**  Parameters:
+**	  at: index in the receive ring of a '$'
+**	  parsed: micros() when feed() parsed the '$'
+**
+**  Return Value:
+**    sentenceArrival(): micros() when the '$' at that index was put
+**		in the ring, or parsed if that was not noted
+**
+**  Description:
+**    A single producer / single consumer queue beside the receive
+**	  ring. stampSentence() runs where the byte is pushed, so LATENCY
+**	  and MICROS do not include the time the sentence waited in the
+**	  ring. A '$' that arrives while PPS_STAMPS are waiting gets no
+**	  stamp, and the queue front then belongs to a later '$', so it is
+**	  only taken when its index matches.
+*/
+void IRAM_ATTR GPS::stampSentence(uint8_t at)
+{
+	uint8_t next = (stampHead + 1) % PPS_STAMPS;
+
+	if (next == stampTail){
+		return;
+	}
+	stampAt[stampHead] = at;
+	stampMicros[stampHead] = micros();
+	stampHead = next;
+}
+
+uint32_t GPS::sentenceArrival(uint8_t at, uint32_t parsed)
+{
+	uint32_t arrived;
+
+	if (stampTail == stampHead || stampAt[stampTail] != at){
+		return parsed;
+	}
+	arrived = stampMicros[stampTail];
+	stampTail = (stampTail + 1) % PPS_STAMPS;
+	return arrived;
+}
+
+/* ------------------------------------------------------------ */
+/*  getFixTime()
+**
+**  Parameters:
+**	  none
+**
+**  Return Value:
+**    The local time of the latest fix, see FIX_TIME
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    MICROS is when the PmodGPS measured the fix, so it can be
+**	  matched against other sensors' micros() timestamps, and LATENCY
+**	  is how old the fix was when it started arriving.
+*/
+const FIX_TIME& GPS::getFixTime()
+{
+	return fixTime;
+}
+
+/* ------------------------------------------------------------ */
+/*  getUTCAt()
+**
+**  Parameters:
+**	  localMicros: a micros() timestamp, such as another sensor's
+**	  utc: set to the UTC at localMicros, ms since midnight
+**
+**  Return Value:
+**    true if utc was set, false if there has not been a pulse in the
+**	  PPS_HOLDOVER ms before localMicros
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Uses the last pulse tied to a fix as the time reference, the
+**	  error is that of micros() over the time since the pulse.
+*/
+bool GPS::getUTCAt(uint32_t localMicros, uint32_t* utc)
+{
+	uint32_t elapsed = localMicros - ppsLocal;
+
+	if (!ppsTied || elapsed >= PPS_HOLDOVER * 1000UL){
+		return false;
+	}
+	*utc = (ppsUTC + elapsed / 1000) % 86400000UL;
+	return true;
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/*  setFilter(), getFilteredFix()
+**
+**  Parameters:
+**	 	mode: FILTER_OFF, FILTER_ALPHA_BETA or FILTER_KALMAN
+**
+**  Return Value:
+**    The latest fix with the position, altitude, speed and course
+**		replaced by the filtered ones
+**
+**  Errors:
+**    The fix is returned unchanged when the filter is off or has
+**		not had a position yet
+**
+**  Description:
+**    Each GGA with a fix is filtered as it is parsed, weighted by
+**		its HDOP and the VDOP from GSA. VTG or RMC speed and course
+**		correct the filter's velocity. See GPSFilter.h.
+*/
+#if GPS_USE_FILTER
+void GPS::setFilter(FILTER_MODE mode){
+	filter.setMode(mode);
+}
+
+FIX GPS::getFilteredFix(){
+	FIX filtered = fix;
+	FILTER_STATE state;
+
+	if (filter.getMode() != FILTER_OFF && filter.isValid()){
+		state = filter.getState();
+		filtered.LAT = state.LAT;
+		filtered.LON = state.LON;
+		filtered.ALT = state.ALT;
+		filtered.SPEED = state.SPEED;
+		filtered.COURSE = state.COURSE;
+	}
+	return filtered;
+}
+#endif
+
+
+/* ------------------------------------------------------------ */
+/*  getStats(), clearStats()
+**
+**  Parameters:
+**	 	type: The sentence type to get the counts of, INVALID for
+**			sentences of a type the library does not decode
+**
+**  Return Value:
+**    The accepted, rejected and truncated sentence counts
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Counts kept by feed() for monitoring the link to the PmodGPS.
+**		The counts wrap around at 65535.
+*/
+NMEA_STATS GPS::getStats(NMEA type){
+	return stats[type];
+}
+
+void GPS::clearStats(){
+	memset(stats, 0, sizeof(stats));
+}
+
+/* ------------------------------------------------------------ */
+/*  countTruncated()
+**
+**  Parameters:
+**	 	none
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Counts the sentence being assembled as truncated, under its
+**		type if enough of it arrived to tell.
+*/
+void GPS::countTruncated(){
+	NMEA mode = INVALID;
+
+	if (sentenceLen > 7){
+		mode = chooseMode(sentence);
+	}
+	stats[mode].truncated++;
+}
+
+
+/* ------------------------------------------------------------ */
+/*					Private Functions							*/
+
+/* ------------------------------------------------------------ */
+/*  updateEpoch()
+**
+**  Parameters:
+**	  mode: The sentence just formatted
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    GGA, RMC, GLL and ZDA carry the fix time, a new time starts a
+**	  new epoch. Other sentences belong to the epoch in progress. GSV only
+**	  counts once its last part has arrived.
+*/
+void GPS::updateEpoch(NMEA mode)
+{
+	bool wasComplete;
+
+	if ((mode == GGA || mode == RMC || mode == GLL || mode == ZDA) && fix.UTC != epochUTC){
+		epochUTC = fix.UTC;
+		epochMask = 0;
+#if GPS_USE_GSV
+		skyEpoch++;
+#endif
+#if GPS_USE_PPS
+		updateFixTime();
+#endif
+	}
+	if (mode == GSV && !gsvDone){
+		return;
+	}
+	wasComplete = isEpochComplete();
+	epochMask |= NMEA_BIT(mode);
+	if (!wasComplete && isEpochComplete()){
+		epochDone = true;
+		epochFix = fix;
+		epochSequence++;
+	}
+}
+/* ------------------------------------------------------------ */
+
+/* ------------------------------------------------------------ */
+/*  chooseMode()
+**
+**  Parameters:
+**	  char recv[MAX_SIZE]
+**
+**  Return Value:
+**    NMEA mode: The format of the sentence, for use in deciding
+**	   which struct to format into
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Packs the three character sentence formatter after the talker
+**	  ID into an integer and looks it up with a single switch. Any
+**	  talker is accepted ($GP, $GN, $GL, $GA, $GB, ...). Proprietary
+**	  sentences start with 'P' instead of a talker, of those only
+**	  the $PMTK001 acknowledgement is decoded.
+*/
+#define ADDR(a, b, c)	(((uint32_t)(uint8_t)(a) << 16) | ((uint32_t)(uint8_t)(b) << 8) | (uint8_t)(c))
+
+NMEA GPS::chooseMode(char recv[MAX_SIZE]){
+	if (recv[1] == 'P'){//$PMTK001
+#if GPS_USE_ACK
+		if (ADDR(recv[2], recv[3], recv[4]) == ADDR('M', 'T', 'K') && ADDR(recv[5], recv[6], recv[7]) == ADDR('0', '0', '1')){
+			return PMTK_ACK;
+		}
+#endif
+		return INVALID;
+	}
+	if (recv[1] < 'A' || recv[1] > 'Z' || recv[2] < 'A' || recv[2] > 'Z'){
+		return INVALID;
+	}
+	switch(ADDR(recv[3], recv[4], recv[5])){
+#if GPS_USE_GGA
+		case ADDR('G', 'G', 'A'):return GGA;
+#endif
+#if GPS_USE_GSA
+		case ADDR('G', 'S', 'A'):return GSA;
+#endif
+#if GPS_USE_GSV
+		case ADDR('G', 'S', 'V'):return GSV;
+#endif
+#if GPS_USE_RMC
+		case ADDR('R', 'M', 'C'):return RMC;
+#endif
+#if GPS_USE_VTG
+		case ADDR('V', 'T', 'G'):return VTG;
+#endif
+#if GPS_USE_GLL
+		case ADDR('G', 'L', 'L'):return GLL;
+#endif
+#if GPS_USE_ZDA
+		case ADDR('Z', 'D', 'A'):return ZDA;
+#endif
+#if GPS_USE_TXT
+		case ADDR('T', 'X', 'T'):return TXT;
+#endif
+	}
+	return INVALID;
+}
+
+
+#if GPS_USE_STRINGS
+/* ------------------------------------------------------------ */
+/*  Field tables
+**
+**  Description:
+**    One entry per comma separated field following the sentence
+**	  address, in the order the PmodGPS sends them. Each entry names
+**	  how the field is stored and where in the sentence's struct it
+**	  goes. Adding a sentence only needs a struct and a table. Only
+**	  built with GPS_USE_STRINGS.
+*/
+#define FIELD(type, st, member)	{type, offsetof(st, member), sizeof(((st*)0)->member)}
+
+#if GPS_USE_GGA
+static const FIELD_MAP GGAmap[] PROGMEM = {
+	FIELD(F_STR, GGA_DATA, UTC),
+	FIELD(F_COORD, GGA_DATA, LAT),
+	FIELD(F_HEMI, GGA_DATA, NS),
+	FIELD(F_COORD, GGA_DATA, LONG),
+	FIELD(F_HEMI, GGA_DATA, EW),
+	FIELD(F_CHAR, GGA_DATA, PFI),
+	FIELD(F_STR, GGA_DATA, NUMSAT),
+	FIELD(F_STR, GGA_DATA, HDOP),
+	FIELD(F_STR, GGA_DATA, ALT),
+	FIELD(F_CHAR, GGA_DATA, AUNIT),
+	FIELD(F_STR, GGA_DATA, GSEP),
+	FIELD(F_CHAR, GGA_DATA, GUNIT),
+	FIELD(F_STR, GGA_DATA, AODC)
+};
+#endif
+
+#if GPS_USE_GSA
+static const FIELD_MAP GSAmap[] PROGMEM = {
+	FIELD(F_CHAR, GSA_DATA, MODE1),
+	FIELD(F_CHAR, GSA_DATA, MODE2),
+	FIELD(F_STR, GSA_DATA, SAT1),
+	FIELD(F_STR, GSA_DATA, SAT2),
+	FIELD(F_STR, GSA_DATA, SAT3),
+	FIELD(F_STR, GSA_DATA, SAT4),
+	FIELD(F_STR, GSA_DATA, SAT5),
+	FIELD(F_STR, GSA_DATA, SAT6),
+	FIELD(F_STR, GSA_DATA, SAT7),
+	FIELD(F_STR, GSA_DATA, SAT8),
+	FIELD(F_STR, GSA_DATA, SAT9),
+	FIELD(F_STR, GSA_DATA, SAT10),
+	FIELD(F_STR, GSA_DATA, SAT11),
+	FIELD(F_STR, GSA_DATA, SAT12),
+	FIELD(F_STR, GSA_DATA, PDOP),
+	FIELD(F_STR, GSA_DATA, HDOP),
+	FIELD(F_STR, GSA_DATA, VDOP)
+};
+#endif
+
+#if GPS_USE_GSV
+static const FIELD_MAP GSVmap[] PROGMEM = {
+	FIELD(F_INT, GSV_DATA, NUMM),
+	FIELD(F_INT, GSV_DATA, MESNUM),
+	FIELD(F_INT, GSV_DATA, SATVIEW)
+};
+#endif
+
+#if GPS_USE_RMC
+static const FIELD_MAP RMCmap[] PROGMEM = {
+	FIELD(F_STR, RMC_DATA, UTC),
+	FIELD(F_CHAR, RMC_DATA, STAT),
+	FIELD(F_STR, RMC_DATA, LAT),
+	FIELD(F_CHAR, RMC_DATA, NS),
+	FIELD(F_STR, RMC_DATA, LONG),
+	FIELD(F_CHAR, RMC_DATA, EW),
+	FIELD(F_STR, RMC_DATA, SOG),
+	FIELD(F_STR, RMC_DATA, COG),
+	FIELD(F_STR, RMC_DATA, DATE),
+	FIELD(F_STR, RMC_DATA, MVAR),
+	FIELD(F_CHAR, RMC_DATA, MVARDIR),
+	FIELD(F_CHAR, RMC_DATA, MODE)
+};
+#endif
+
+#if GPS_USE_VTG
+static const FIELD_MAP VTGmap[] PROGMEM = {
+	FIELD(F_STR, VTG_DATA, COURSE_T),
+	FIELD(F_CHAR, VTG_DATA, REF_T),
+	FIELD(F_STR, VTG_DATA, COURSE_M),
+	FIELD(F_CHAR, VTG_DATA, REF_M),
+	FIELD(F_STR, VTG_DATA, SPD_N),
+	FIELD(F_CHAR, VTG_DATA, UNIT_N),
+	FIELD(F_STR, VTG_DATA, SPD_KM),
+	FIELD(F_CHAR, VTG_DATA, UNIT_KM),
+	FIELD(F_CHAR, VTG_DATA, MODE)
+};
+#endif
+
+#if GPS_USE_GLL
+static const FIELD_MAP GLLmap[] PROGMEM = {
+	FIELD(F_STR, GLL_DATA, LAT),
+	FIELD(F_CHAR, GLL_DATA, NS),
+	FIELD(F_STR, GLL_DATA, LONG),
+	FIELD(F_CHAR, GLL_DATA, EW),
+	FIELD(F_STR, GLL_DATA, UTC),
+	FIELD(F_CHAR, GLL_DATA, STAT),
+	FIELD(F_CHAR, GLL_DATA, MODE)
+};
+#endif
+
+#if GPS_USE_ZDA
+static const FIELD_MAP ZDAmap[] PROGMEM = {
+	FIELD(F_STR, ZDA_DATA, UTC),
+	FIELD(F_STR, ZDA_DATA, DAY),
+	FIELD(F_STR, ZDA_DATA, MONTH),
+	FIELD(F_STR, ZDA_DATA, YEAR),
+	FIELD(F_STR, ZDA_DATA, ZONEH),
+	FIELD(F_STR, ZDA_DATA, ZONEM)
+};
+#endif
+
+#if GPS_USE_TXT
+static const FIELD_MAP TXTmap[] PROGMEM = {
+	FIELD(F_STR, TXT_DATA, TOTAL),
+	FIELD(F_STR, TXT_DATA, NUM),
+	FIELD(F_STR, TXT_DATA, ID),
+	FIELD(F_STR, TXT_DATA, TEXT)
+};
+#endif
+
+#if GPS_USE_ACK
+static const FIELD_MAP ACKmap[] PROGMEM = {
+	FIELD(F_STR, ACK_DATA, CMD),
+	FIELD(F_CHAR, ACK_DATA, FLAG)
+};
+#endif
+#endif //GPS_USE_STRINGS
+
+#define MAP_SIZE(map)	(sizeof(map) / sizeof(map[0]))
+
+/* ------------------------------------------------------------ */
+/*  Fix tables
+**
+**  Description:
+**    The data fields of each sentence that are also decoded into
+**	  the numeric FIX. Latitude and longitude use the hemisphere in
+**	  the field that follows them.
+*/
+#if GPS_USE_GGA
+static const FIX_MAP GGAfix[] PROGMEM = {
+	{0, N_TIME, offsetof(FIX, UTC)},
+	{1, N_LAT, offsetof(FIX, LAT)},
+	{3, N_LON, offsetof(FIX, LON)},
+	{5, N_U8, offsetof(FIX, PFI)},
+	{6, N_U8, offsetof(FIX, NUMSAT)},
+	{7, N_DOP, offsetof(FIX, HDOP)},
+	{8, N_CM, offsetof(FIX, ALT)}
+};
+#endif
+
+#if GPS_USE_GSA
+static const FIX_MAP GSAfix[] PROGMEM = {
+	{14, N_DOP, offsetof(FIX, PDOP)},
+	{16, N_DOP, offsetof(FIX, VDOP)}
+};
+#endif
+
+#if GPS_USE_RMC
+static const FIX_MAP RMCtime[] PROGMEM = {//Set whatever the status
+	{0, N_TIME, offsetof(FIX, UTC)},
+	{8, N_DATE, offsetof(FIX, DAY)}
+};
+static const FIX_MAP RMCfix[] PROGMEM = {//Set only with status A
+	{2, N_LAT, offsetof(FIX, LAT)},
+	{4, N_LON, offsetof(FIX, LON)},
+	{6, N_KNOTS, offsetof(FIX, SPEED)},
+	{7, N_COURSE, offsetof(FIX, COURSE)}
+};
+#endif
+
+#if GPS_USE_VTG
+static const FIX_MAP VTGfix[] PROGMEM = {
+	{0, N_COURSE, offsetof(FIX, COURSE)},
+	{6, N_KMH, offsetof(FIX, SPEED)}
+};
+#endif
+
+#if GPS_USE_GLL
+static const FIX_MAP GLLtime[] PROGMEM = {//Set whatever the status
+	{4, N_TIME, offsetof(FIX, UTC)}
+};
+static const FIX_MAP GLLfix[] PROGMEM = {//Set only with status A
+	{0, N_LAT, offsetof(FIX, LAT)},
+	{2, N_LON, offsetof(FIX, LON)}
+};
+#endif
+
+#if GPS_USE_ZDA
+static const FIX_MAP ZDAfix[] PROGMEM = {
+	{0, N_TIME, offsetof(FIX, UTC)},
+	{1, N_U8, offsetof(FIX, DAY)},
+	{2, N_U8, offsetof(FIX, MONTH)},
+	{3, N_YEAR, offsetof(FIX, YEAR)}
+};
+#endif
+
+#if GPS_USE_STRINGS
+/* ------------------------------------------------------------ */
+/*  copyField()
+**
+**  Parameters:
+**	  dest: the char array to copy into
+**	  size: the size of dest in bytes
+**	  data_array: the sentence the field is in
+**	  field: the field to copy
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Copies a field into a char array as a null terminated string,
+**	  cutting it short if it does not fit.
+*/
+static void copyField(char* dest, uint8_t size, const char* data_array, NMEA_FIELD field)
+{
+	uint8_t len = field.len;
+
+	if (len > size - 1){
+		len = size - 1;
+	}
+	memcpy(dest, data_array + field.start, len);
+	dest[len] = '\0';//End null char
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/*  tokenize()
+**
+**  Parameters:
+**	  data_array: the sentence to split, ending with <LF>
+**	  fields: array of MAX_FIELDS fields to fill in
+**	  checksum: filled in with the two checksum digits after '*'
+**
+**  Return Value:
+**    The number of fields found, including the address field
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Splits a sentence into its comma separated fields in a single
+**	  scan. Nothing is copied, each field is an offset and length
+**	  into data_array. fields[0] is the address ("GPGGA"), the data
+**	  fields follow in order. Fields past MAX_FIELDS are ignored.
+*/
+uint8_t GPS::tokenize(const char* data_array, NMEA_FIELD* fields, NMEA_FIELD* checksum)
+{
+	uint8_t numFields = 0;
+	uint8_t start = 1;//Skip the '$'
+	uint8_t i;
+	char c;
+
+	checksum->start = 0;
+	checksum->len = 0;
+
+	for (i = start; ; i++){
+		c = data_array[i];
+		if (c == ',' || c == '*' || c == '\r' || c == 10 || c == '\0'){
+			if (numFields < MAX_FIELDS){
+				fields[numFields].start = start;
+				fields[numFields].len = i - start;
+				numFields++;
+			}
+			start = i + 1;
+			if (c == '*'){//Two hex digits follow
+				checksum->start = start;
+				checksum->len = (data_array[start] && data_array[start + 1]) ? 2 : 0;
+			}
+			if (c != ','){
 				break;
-			case COG:
-				memcpy(RMCdata.COG, start_ptr, (end_ptr - start_ptr));
-				RMCdata.COG[end_ptr - start_ptr] = '\0';//End null char
-				datamember=DATE;
+			}
+		}
+	}
+	return numFields;
+}
+
+#if GPS_USE_STRINGS
+/* ------------------------------------------------------------ */
+/*  formatFields()
+**
+**  Parameters:
+**	  data_array: the sentence the fields are in
+**	  fields: the sentence's data fields, not including the address
+**	  numFields: the number of entries in fields
+**	  map: field table in PROGMEM describing where each field goes
+**	  mapSize: the number of entries in map
+**	  dest: the struct to store the fields in
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Stores each field into dest as described by its table entry.
+**	  Empty single character fields keep their previous value.
+*/
+void GPS::formatFields(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields, const FIELD_MAP* map, uint8_t mapSize, void* dest)
+{
+	FIELD_MAP entry;
+	uint8_t coordOffset = 0;
+	uint8_t coordSize = 0;
+	int32_t degE7;
+	char* member;
+	size_t len;
+	uint8_t i;
+
+	if (numFields > mapSize){
+		numFields = mapSize;
+	}
+	for (i = 0; i < numFields; i++){
+		memcpy_P(&entry, &map[i], sizeof(FIELD_MAP));
+		member = (char*)dest + entry.offset;
+
+		switch(entry.type){
+			case F_CHAR:
+				if (fields[i].len)*member = data_array[fields[i].start];
 				break;
-			case DATE:
-				memcpy(RMCdata.DATE, start_ptr, (end_ptr - start_ptr));
-				RMCdata.DATE[end_ptr - start_ptr] = '\0';//End null char
-				datamember=MVAR;
+			case F_STR:
+				copyField(member, entry.size, data_array, fields[i]);
 				break;
-			case MVAR:
-				memcpy(RMCdata.MVAR, start_ptr, (end_ptr - start_ptr));
-				RMCdata.MVAR[end_ptr - start_ptr] = '\0';//End null char
-				datamember=MVARDIR;
+			case F_INT:
+				*(int*)member = atoi(data_array + fields[i].start);
 				break;
-			case MVARDIR:
-				if (*start_ptr!=',')RMCdata.MVARDIR = *start_ptr;
-				datamember=MODE;
+			case F_COORD:
+				coordOffset = entry.offset;
+				coordSize = entry.size;
+				if (fields[i].len && decodeCoordinate(data_array + fields[i].start, fields[i].len, 0, &degE7)){
+					formatDMS(member, entry.size - 1, degE7, 0, 0);//Room for the hemisphere
+				}
 				break;
-			case MODE:
-				if (*start_ptr!=',')RMCdata.MODE = *start_ptr;
-				flag=0;
+			case F_HEMI:
+				if (fields[i].len){
+					*member = data_array[fields[i].start];
+					len = coordSize ? strlen((char*)dest + coordOffset) : 0;
+					if (len && len < coordSize - 1u){
+						((char*)dest)[coordOffset + len] = *member;
+						((char*)dest)[coordOffset + len + 1] = 0;
+					}
+				}
 				break;
+		}
+	}
+}
+#endif
+
+/* ------------------------------------------------------------ */
+/*  parseDecimal()
+**
+**  Parameters:
+**	  str: the field to parse
+**	  len: the number of characters in the field
+**	  decimals: the number of decimal places to keep
+**
+**  Return Value:
+**    The value of the field times 10^decimals
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Integer only conversion of a decimal field such as "-12.345".
+**	  Extra decimal places are dropped, missing ones are zero.
+*/
+static int32_t parseDecimal(const char* str, uint8_t len, uint8_t decimals)
+{
+	int32_t value = 0;
+	bool negative = false;
+	bool fraction = false;
+	uint8_t i = 0;
+
+	if (len && *str == '-'){
+		negative = true;
+		i++;
+	}
+	for (; i < len; i++){
+		if (str[i] == '.'){
+			fraction = true;
+		}
+		else if (!fraction || decimals){
+			value = value * 10 + (str[i] - '0');
+			if (fraction){
+				decimals--;
 			}
-		end_ptr++;
-	} //end of while 
-	
-	//Get checksum
-	while(*(end_ptr)!=10)end_ptr++;
-		checksum[0] = *(end_ptr - 3);
-		checksum[1] = *(end_ptr - 2);
-		checksum[2] = NULL;
-	memcpy(RMCdata.CHECKSUM, checksum, 3);
-	//Serial.print("CHECKSUM: ");Serial.println(RMCdata.CHECKSUM);
-	return;
+		}
+	}
+	while (decimals--){
+		value *= 10;
+	}
+	return negative ? -value : value;
 }
 
 /* ------------------------------------------------------------ */
-/*  formatVTG()
+/*  updateFix()
 **
 **  Parameters:
-**	  data: an array to the data to be formatted
-**	  VTGdata: a pointer to the VTG_DATA structure to store the parsed data in
+**	  data_array: the sentence the fields are in
+**	  fields: the sentence's data fields, not including the address
+**	  numFields: the number of entries in fields
+**	  map: fix table in PROGMEM for the sentence
+**	  mapSize: the number of entries in map
 **
 **  Return Value:
 **    none
@@ -992,138 +2505,427 @@ void GPS::formatRMC(char* data_array)
 **    none
 **
 **  Description:
-**    Formats a mode's data into elements in a struct.
-*/
-void GPS::formatVTG(char* data_array)
-{
-	enum cases {COURSE_T, REF_T, COURSE_M, REF_M, SPD_N, UNIT_N, SPD_KM, UNIT_KM, MODE, CHECKSUM};
-	cases datamember=COURSE_T;
-	char* start_ptr;
-	char* end_ptr = data_array+7;//Set start pointer after the message ID ("$GPGGA,")
-	bool flag=1;
-	char checksum[3]={0};
-	
-	while (flag)
-	{
-		start_ptr = end_ptr;
-		
-		while (*end_ptr!=',' && (*(end_ptr+1)!=10)&& *end_ptr!='*')end_ptr++;//Increment ptr until a comma is found
-		
-		if (*end_ptr==10||*(end_ptr+1)==10||(*end_ptr=='*'&&*(end_ptr-1)==',')){//End reached
-			flag=0;
-			break;
+**    Converts the fields named in map into the numeric fix. Empty
+**	  fields leave the previous value.
+*/
+void GPS::updateFix(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields, const FIX_MAP* map, uint8_t mapSize)
+{
+	FIX_MAP entry;
+	uint8_t* member;
+	const char* str;
+	uint8_t len;
+	char hemisphere;
+	int32_t value;
+	uint8_t i;
+
+	for (i = 0; i < mapSize; i++){
+		memcpy_P(&entry, &map[i], sizeof(FIX_MAP));
+		if (entry.field >= numFields || fields[entry.field].len == 0){
+			continue;
 		}
-		//Choose where to put this data
-		switch(datamember){
-			case COURSE_T:
-				memcpy(VTGdata.COURSE_T, start_ptr, (end_ptr - start_ptr));
-				VTGdata.COURSE_T[end_ptr - start_ptr] = '\0';//End null char
-				datamember = REF_T;
+		str = data_array + fields[entry.field].start;
+		len = fields[entry.field].len;
+		member = (uint8_t*)&fix + entry.offset;
+
+		switch(entry.type){
+			case N_TIME://hhmmss.sss
+				value = parseDecimal(str, len, 3);
+				*(uint32_t*)member = (value / 10000000L) * 3600000L + (value / 100000L % 100) * 60000L + value % 100000L;
 				break;
-			case REF_T:
-				if (*start_ptr!=',')VTGdata.REF_T = *start_ptr;
-				datamember=COURSE_M;
+			case N_LAT:
+			case N_LON:
+				hemisphere = (entry.field + 1 < numFields) ? data_array[fields[entry.field + 1].start] : 0;
+				decodeCoordinate(str, len, hemisphere, (int32_t*)member);
 				break;
-			case COURSE_M:
-				memcpy(VTGdata.COURSE_M, start_ptr, (end_ptr - start_ptr));
-				VTGdata.COURSE_M[end_ptr - start_ptr] = '\0';//End null char
-				datamember=REF_M;
+			case N_U8:
+				*member = (uint8_t)parseDecimal(str, len, 0);
 				break;
-			case REF_M:
-				if (*start_ptr!=',')VTGdata.REF_M = *start_ptr;
-				datamember=SPD_N;
+			case N_DOP:
+			case N_COURSE:
+				*(uint16_t*)member = (uint16_t)parseDecimal(str, len, 2);
 				break;
-			case SPD_N:
-				memcpy(VTGdata.SPD_N, start_ptr, (end_ptr - start_ptr));
-				VTGdata.SPD_N[end_ptr - start_ptr] = '\0';//End null char
-				datamember=UNIT_N;
+			case N_CM:
+				*(int32_t*)member = parseDecimal(str, len, 2);
 				break;
-			case UNIT_N:
-				if (*start_ptr!=',')VTGdata.UNIT_N = *start_ptr;
-				datamember=SPD_KM;
+			case N_KNOTS://1 knot = 1852/3.6 mm/s
+				*(uint32_t*)member = (parseDecimal(str, len, 3) * 463 + 450) / 900;
 				break;
-			case SPD_KM:
-				memcpy(VTGdata.SPD_KM, start_ptr, (end_ptr - start_ptr));
-				VTGdata.SPD_KM[end_ptr - start_ptr] = '\0';//End null char
-				datamember=UNIT_KM;
+			case N_KMH://1 km/h = 1000/3.6 mm/s
+				*(uint32_t*)member = (parseDecimal(str, len, 3) * 5 + 9) / 18;
 				break;
-			case UNIT_KM:
-				if (*start_ptr!=',')VTGdata.UNIT_KM = *start_ptr;
-				datamember=MODE;
+			case N_DATE://ddmmyy into DAY, MONTH, YEAR
+				if (len == 6){
+					value = parseDecimal(str, len, 0);
+					member[0] = (uint8_t)(value / 10000);
+					member[1] = (uint8_t)(value / 100 % 100);
+					member[2] = (uint8_t)(value % 100);
+				}
 				break;
-			case MODE:
-				if (*start_ptr!=',')VTGdata.MODE = *start_ptr;
-				datamember=CHECKSUM;
-				flag=0;
+			case N_YEAR:
+				*member = (uint8_t)(parseDecimal(str, len, 0) % 100);
 				break;
-			
-			}
-		end_ptr++;
-	} //end of while 
-		
-	//Get checksum
-	while(*(end_ptr)!=10)end_ptr++;
-		checksum[0] = *(end_ptr - 3);
-		checksum[1] = *(end_ptr - 2);
-		checksum[2] = NULL;
-	memcpy(VTGdata.CHECKSUM, checksum, 3);
-	//Serial.print("CHECKSUM: ");Serial.println(VTGdata.CHECKSUM);
-	return;
+		}
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  formatGGA(), formatGSA(), formatRMC(), formatVTG(), formatGLL(),
+**	formatZDA()
+**
+**  Parameters:
+**	  data_array: the sentence to be formatted
+**	  fields: the fields of the sentence found by tokenize()
+**	  numFields: the number of entries in fields
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    none
+**
+**  Description:
+**    Formats a mode's data into elements in a struct using the
+**		sentence's field table, then decodes its numeric values
+**		into the fix. Each is only built with its GPS_USE_ setting,
+**		the struct only with GPS_USE_STRINGS.
+*/
+#if GPS_USE_STRINGS
+#define FORMAT_STRINGS(map, data)	formatFields(data_array, fields + 1, numFields - 1, map, MAP_SIZE(map), &data)
+#else
+#define FORMAT_STRINGS(map, data)	(void)data_array, (void)fields, (void)numFields
+#endif
+
+#if GPS_USE_GGA
+void GPS::formatGGA(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	FORMAT_STRINGS(GGAmap, GGAdata);
+	updateFix(data_array, fields + 1, numFields - 1, GGAfix, MAP_SIZE(GGAfix));
+#if GPS_USE_FILTER
+	if (fix.PFI){
+		filter.updatePosition(fix.LAT, fix.LON, fix.ALT, fix.UTC, fix.HDOP, fix.VDOP);
+	}
+#endif
+}
+#endif
+
+#if GPS_USE_GSA
+void GPS::formatGSA(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	FORMAT_STRINGS(GSAmap, GSAdata);
+	updateFix(data_array, fields + 1, numFields - 1, GSAfix, MAP_SIZE(GSAfix));
+}
+#endif
+
+#if GPS_USE_RMC
+void GPS::formatRMC(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	bool valid = numFields > 2 && fields[2].len && data_array[fields[2].start] == 'A';//Status: A = data valid, V = warning
+
+	FORMAT_STRINGS(RMCmap, RMCdata);
+	updateFix(data_array, fields + 1, numFields - 1, RMCtime, MAP_SIZE(RMCtime));
+	if (!valid){//The position, speed and course are the last good ones or zero, keep those in fix
+		return;
+	}
+	updateFix(data_array, fields + 1, numFields - 1, RMCfix, MAP_SIZE(RMCfix));
+#if GPS_USE_FILTER
+	if (fix.PFI){
+		filter.updateVelocity(fix.SPEED, fix.COURSE, fix.HDOP);
+	}
+#endif
+}
+#endif
+
+#if GPS_USE_VTG
+void GPS::formatVTG(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	FORMAT_STRINGS(VTGmap, VTGdata);
+	updateFix(data_array, fields + 1, numFields - 1, VTGfix, MAP_SIZE(VTGfix));
+#if GPS_USE_FILTER
+	if (fix.PFI){
+		filter.updateVelocity(fix.SPEED, fix.COURSE, fix.HDOP);
+	}
+#endif
+}
+#endif
+
+#if GPS_USE_GLL
+void GPS::formatGLL(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	bool valid = numFields > 6 && fields[6].len && data_array[fields[6].start] == 'A';//Status: A = data valid, V = warning
+
+	FORMAT_STRINGS(GLLmap, GLLdata);
+	updateFix(data_array, fields + 1, numFields - 1, GLLtime, MAP_SIZE(GLLtime));
+	if (valid){
+		updateFix(data_array, fields + 1, numFields - 1, GLLfix, MAP_SIZE(GLLfix));
+	}
+}
+#endif
+
+#if GPS_USE_ZDA
+void GPS::formatZDA(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	FORMAT_STRINGS(ZDAmap, ZDAdata);
+	updateFix(data_array, fields + 1, numFields - 1, ZDAfix, MAP_SIZE(ZDAfix));
 }
+#endif
 
 /* ------------------------------------------------------------ */
-/*  char* formatCOORDS()
+/*  formatTXT(), formatAck()
 **
 **  Parameters:
-**	  coords: the un-formatted decimal representation of latitude or longitude
+**	  data_array: the sentence to be formatted
+**	  fields: the fields of the sentence found by tokenize()
+**	  numFields: the number of entries in fields
 **
 **  Return Value:
-**    Correctly formatted coordinates in degrees, minutes, and seconds
+**    none
 **
 **  Errors:
 **    none
 **
 **  Description:
-**    Formats a set of coordinates of the form XXXX.XXXX or XXXXX.XXXX
-**	  into XX°XX'XX.XX" (or XXX°XX'XX.XX")
-*/
-void GPS::formatCOORDS(char* coords)
-{
-	char formatted[14]={0};
-	int i=0;
-	char* coordsstart= coords;
-	
-	while (*(coords)){
-		
-		formatted[i]=*coords;
-		formatted[++i]; coords++;
-		if (*(coords+2)=='.')
-		{
-			formatted[i]='°';//degrees symbol
-			i++;
+**    Formats sentences that carry no fix data into their structs.
+**	  formatAck() also completes the command from sendCommand() when
+**	  its acknowledgement arrives.
+*/
+#if GPS_USE_TXT
+void GPS::formatTXT(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	FORMAT_STRINGS(TXTmap, TXTdata);
+}
+#endif
+
+#if GPS_USE_ACK
+void GPS::formatAck(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	FORMAT_STRINGS(ACKmap, ACKdata);
+	if (numFields < 3 || fields[2].len != 1){
+		return;
+	}
+	if ((commandState == CMD_WAITING || commandState == CMD_SENDING)
+		&& parseDecimal(data_array + fields[1].start, fields[1].len, 0) == commandNumber){
+		commandFlag = data_array[fields[2].start];
+		commandState = (commandFlag == '3') ? CMD_DONE : CMD_FAILED;
+	}
+}
+#endif
+
+#if GPS_USE_GSV
+/* ------------------------------------------------------------ */
+/*  talkerSystem(), satelliteSystem(), talkerReports()
+**
+**  Parameters:
+**	  talker: TALKER() of the GSV sentence
+**	  system: the talker's system, from talkerSystem()
+**	  id: satellite ID from the GSV sentence
+**	  sat: a satellite in the sky view
+**
+**  Return Value:
+**    the GNSS_SYSTEM a talker reports, SYS_UNKNOWN for $GN, the
+**	  system a satellite belongs to, and whether a GSV series from
+**	  the talker lists the satellite when it is in view
+**
+**  Description:
+**    $GP and $GN sentences number satellites from every system in
+**	  one range (NMEA 0183 4.x), the others use the system's own IDs.
+**	  $GPGSV carries GPS and the SBAS and QZSS satellites that
+**	  augment it, $GNGSV carries every system.
+*/
+static uint8_t talkerSystem(uint16_t talker)
+{
+	switch(talker){
+		case TALKER('G', 'P'):return SYS_GPS;
+		case TALKER('G', 'L'):return SYS_GLONASS;
+		case TALKER('G', 'A'):return SYS_GALILEO;
+		case TALKER('G', 'B'):
+		case TALKER('B', 'D'):return SYS_BEIDOU;
+		case TALKER('G', 'Q'):
+		case TALKER('Q', 'Z'):return SYS_QZSS;
+	}
+	return SYS_UNKNOWN;
+}
+
+static uint8_t satelliteSystem(uint8_t system, uint8_t id)
+{
+	if (system != SYS_GPS && system != SYS_UNKNOWN){
+		return system;
+	}
+	if (id >= 33 && id <= 64){
+		return SYS_SBAS;
+	}
+	if (id >= 65 && id <= 96){
+		return SYS_GLONASS;
+	}
+	if (id >= 193 && id <= 202){
+		return SYS_QZSS;
+	}
+	return SYS_GPS;
+}
+
+static bool talkerReports(uint8_t system, const SATELLITE* sat)
+{
+	if (system == SYS_UNKNOWN){
+		return true;
+	}
+	if (system == SYS_GPS){
+		return sat->SYSTEM == SYS_GPS || sat->SYSTEM == SYS_SBAS || sat->SYSTEM == SYS_QZSS;
+	}
+	return sat->SYSTEM == system;
+}
+
+/* ------------------------------------------------------------ */
+/*  formatGSV()
+**
+**  Parameters:
+**	  data_array: the sentence to be formatted
+**	  fields: the fields of the sentence found by tokenize()
+**	  numFields: the number of entries in fields
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    A series with a missing, repeated or out of order part is
+**	  thrown away and the published view is left as it was
+**
+**  Description:
+**    Adds the (up to) four satellites of each GSV part to the view
+**		being assembled, keyed by system and ID. The first part of a
+**		series drops the satellites its talker reported in earlier
+**		epochs, the last part publishes the view. Several talkers
+**		($GPGSV, $GLGSV, ...) share the one view.
+*/
+void GPS::formatGSV(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields)
+{
+	const uint8_t header = 4;//Address, NUMM, MESNUM, SATVIEW
+	const uint8_t system = talkerSystem(talker);
+	SKY_VIEW* work = &sky[skyFront ^ 1];
+	SATELLITE sat;
+	uint8_t parts, part;
+	uint8_t i, k;
+
+	FORMAT_STRINGS(GSVmap, GSVdata);
+	gsvDone = false;
+	if (numFields < header){
+		abortSky();
+		return;
+	}
+	parts = (uint8_t)parseDecimal(data_array + fields[1].start, fields[1].len, 0);
+	part = (uint8_t)parseDecimal(data_array + fields[2].start, fields[2].len, 0);
+	if (parts < 1 || part < 1 || part > parts){
+		abortSky();
+		return;
+	}
+	if (part == 1){
+		if (gsvNext){
+			abortSky();//The last series never finished
 		}
-		else if (*coords=='.')
-		{
-			formatted[i] = 39;// ' symbol for minutes
-			i++;
-			coords++;
+		gsvTalker = talker;
+		for (i = 0, k = 0; i < work->COUNT; i++){
+			if (work->SAT[i].EPOCH == skyEpoch || !talkerReports(system, &work->SAT[i])){
+				work->SAT[k++] = work->SAT[i];
+			}
+		}
+		work->COUNT = k;
+	}
+	else if (part != gsvNext || talker != gsvTalker){
+		abortSky();
+		return;
+	}
+
+	for (i = header; i + 4 <= numFields; i += 4){//A lone field left over is the NMEA 4.10 signal ID
+		if (fields[i].len == 0){
+			continue;
 		}
-		else if (*(coords-3)=='.')
-		{
-			formatted[i]='.';//Decimal for seconds
-			i++;
+		sat.ID = (uint8_t)parseDecimal(data_array + fields[i].start, fields[i].len, 0);
+		sat.SYSTEM = satelliteSystem(system, sat.ID);
+		sat.ELV = (int8_t)parseDecimal(data_array + fields[i + 1].start, fields[i + 1].len, 0);
+		sat.AZM = (uint16_t)parseDecimal(data_array + fields[i + 2].start, fields[i + 2].len, 0);
+		sat.SNR = (uint8_t)parseDecimal(data_array + fields[i + 3].start, fields[i + 3].len, 0);
+		sat.EPOCH = skyEpoch;
+		addSatellite(&sat);
+	}
+
+	if (part == parts){
+		publishSky();
+	}
+	else{
+		gsvNext = part + 1;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  addSatellite()
+**
+**  Parameters:
+**	  sat: a satellite from a GSV part
+**
+**  Return Value:
+**    none
+**
+**  Errors:
+**    Counts the satellite in DROPPED if the view is full
+**
+**  Description:
+**    Updates the satellite's entry in the view being assembled, or
+**	  adds one. A satellite sent twice in one epoch, once for each
+**	  signal, keeps its stronger SNR.
+*/
+void GPS::addSatellite(const SATELLITE* sat)
+{
+	SKY_VIEW* work = &sky[skyFront ^ 1];
+	uint8_t i;
+
+	for (i = 0; i < work->COUNT; i++){
+		if (work->SAT[i].ID == sat->ID && work->SAT[i].SYSTEM == sat->SYSTEM){
+			break;
 		}
-		else if (*(coords-5)=='.')
-		{
-			formatted[i]='"';// " for seconds
-			i++;
-			formatted[i]=0;//Null char
+	}
+	if (i == work->COUNT){
+		if (work->COUNT >= GPS_MAX_SATS){
+			if (work->DROPPED < 255){
+				work->DROPPED++;
+			}
+			return;
 		}
+		work->COUNT++;
 	}
+	else if (work->SAT[i].EPOCH == sat->EPOCH && work->SAT[i].SNR > sat->SNR){
+		return;
+	}
+	work->SAT[i] = *sat;
+}
+
+/* ------------------------------------------------------------ */
+/*  publishSky(), abortSky()
+**
+**  Description:
+**    publishSky() drops satellites not reported for SKY_MAX_AGE
+**	  epochs, then swaps the assembled view in with a single index
+**	  change. The next series starts from a copy of the published
+**	  view. abortSky() throws the assembled view away.
+*/
+void GPS::publishSky()
+{
+	SKY_VIEW* work = &sky[skyFront ^ 1];
+	uint8_t i, k;
 
-	strcpy(coordsstart, formatted);
+	for (i = 0, k = 0; i < work->COUNT; i++){
+		if ((uint8_t)(skyEpoch - work->SAT[i].EPOCH) <= SKY_MAX_AGE){
+			work->SAT[k++] = work->SAT[i];
+		}
+	}
+	work->COUNT = k;
+	work->UTC = fix.UTC;
+	skyFront ^= 1;
+	gsvDone = true;
+	abortSky();
+}
 
-	//coords=formatted;
-	return;
-	
+void GPS::abortSky()
+{
+	sky[skyFront ^ 1] = sky[skyFront];
+	sky[skyFront ^ 1].DROPPED = 0;
+	gsvNext = 0;
 }
+#endif //GPS_USE_GSV
@@ -43,8 +43,31 @@
 
 #include "Arduino.h"
 #include "HardwareSerial.h"
+#include "PmodGPSConfig.h"
+#include "GPSRingBuffer.h"
+#include "GPSFilter.h"
 
 #define MAX_SIZE  128
+#define MAX_FIELDS  24		//Most comma separated fields kept per sentence
+
+#ifndef GPS_MAX_SATS
+#define GPS_MAX_SATS  16	//Satellites kept in the sky view, across all constellations
+#endif
+#define SKY_MAX_AGE  5		//Epochs a satellite is kept once its GSV series stops reporting it
+
+#define PMTK_MAX  72		//Longest PMTK command sentence, with its <CR><LF> and null
+#define PMTK_TIMEOUT  1000	//Milliseconds to wait for the $PMTK001 before sending again
+#define PMTK_RETRIES  3		//Times a command is sent before giving up
+
+#define GPS_DEFAULT_BAUD  9600	//Rate of a PmodGPS that has not been told otherwise
+#define GPS_DETECT_TIMEOUT  1500	//Milliseconds detectBaudrate() listens for the PmodGPS
+#define GPS_SYNC_TIMEOUT  2000	//Milliseconds to wait for a valid sentence after changing rate
+
+#define GPS_NO_PIN  0xFF		//Pin number before GPSinit()
+#define PPS_HOLDOVER  2000		//Milliseconds after a pulse that getUTCAt() still answers
+#define PPS_STAMPS  4			//Arrival times kept for sentences waiting in the receive ring
+#define DF_DEBOUNCE  10			//Milliseconds the 3DF pin must hold a new level to count
+#define DF_FIX_TIME  1100		//Milliseconds the 3DF pin must stay low after its last edge to mean a fix
 
 /***********************************************
  * Module Object Class Type Declarations       *
@@ -56,16 +79,78 @@ typedef enum{
 	GSA,			//Operating mode, active satellites, DOP values
 	GSV,			//Satellites in view, satellite ID numbers, elevation, azimuth, SNR values
 	RMC,			//Recommended minimum navigation information
-	VTG				//course and speed relative to ground
+	VTG,				//course and speed relative to ground
+	GLL,				//Geographic position, latitude / longitude
+	ZDA,				//Time and date
+	TXT,				//Text transmission
+	PMTK_ACK		//$PMTK001 acknowledgement of a PMTK command
 } NMEA;
 
+#define NMEA_TYPES  (PMTK_ACK + 1)	//Number of NMEA values, including INVALID
+
+#define TALKER(a, b)  (((uint16_t)(a) << 8) | (uint8_t)(b))	//Packed talker ID, TALKER('G','N')
+
+#define NMEA_BIT(type)  ((uint16_t)1 << (type))	//Bit of a sentence type in an update mask
+#define EPOCH_COMPLETE  0x8000	//Update mask bit set when an epoch's last sentence arrived
+//NMEA_BIT()s of the fix sentences PmodGPSConfig.h builds, only these can be part of an epoch
+#define EPOCH_BUILT  ((GPS_USE_GGA ? NMEA_BIT(GGA) : 0) | (GPS_USE_GSA ? NMEA_BIT(GSA) : 0) | \
+	(GPS_USE_GSV ? NMEA_BIT(GSV) : 0) | (GPS_USE_RMC ? NMEA_BIT(RMC) : 0) | (GPS_USE_VTG ? NMEA_BIT(VTG) : 0) | \
+	(GPS_USE_GLL ? NMEA_BIT(GLL) : 0) | (GPS_USE_ZDA ? NMEA_BIT(ZDA) : 0))
+#define EPOCH_DEFAULT  (EPOCH_BUILT & (NMEA_BIT(GGA) | NMEA_BIT(GSA) | NMEA_BIT(GSV) | NMEA_BIT(RMC) | NMEA_BIT(VTG)))
+
+typedef struct NMEA_STATS_T{
+	uint16_t accepted;		//Checksum matched
+	uint16_t rejected;		//Checksum did not match, sentence discarded
+	uint16_t truncated;	//Cut short, too long or missing its checksum, discarded
+}NMEA_STATS;
+
+typedef struct NMEA_FIELD_T{
+	uint8_t start;	//Offset of the field's first character in the sentence
+	uint8_t len;		//Number of characters in the field, 0 if empty
+}NMEA_FIELD;
+
+typedef enum{
+	F_SKIP = 0,	//Field is not stored
+	F_CHAR,		//Single character, kept if the field is empty
+	F_STR,		//Null terminated copy of the field
+	F_INT,		//Decimal integer stored in an int
+	F_COORD,		//ddmm.mmmm coordinate stored in degrees, minutes, seconds form
+	F_HEMI		//N/S/E/W character, also appended to the preceding F_COORD
+} FIELD_TYPE;
+
+typedef struct FIELD_MAP_T{
+	uint8_t type;		//FIELD_TYPE of the field
+	uint8_t offset;	//offsetof() the destination in the sentence's struct
+	uint8_t size;		//Size of the destination in bytes
+}FIELD_MAP;
+
+typedef enum{
+	SYS_UNKNOWN = 0,
+	SYS_GPS,
+	SYS_SBAS,
+	SYS_GLONASS,
+	SYS_GALILEO,
+	SYS_BEIDOU,
+	SYS_QZSS
+} GNSS_SYSTEM;
+
 typedef struct SATELLITE_T{
-	int ID;		//Satellite ID
-	int ELV;	//Satellite Elevation in degrees (90° max)
-	int AZM;	//Satellite Azimuth, degrees from true north (0° to 359°)
-	int SNR;	//Satellite Signal to noise ratio, 0-99 dB
+	uint16_t AZM;	//Satellite Azimuth, degrees from true north (0° to 359°)
+	uint8_t SYSTEM;	//GNSS_SYSTEM, with ID the satellite's key
+	uint8_t ID;		//Satellite ID (PRN) as sent in the GSV
+	int8_t ELV;		//Satellite Elevation in degrees (90° max)
+	uint8_t SNR;	//Satellite Signal to noise ratio, 0-99 dB, 0 when not tracked
+	uint8_t EPOCH;	//Epoch count when last reported, for ageing out
 }SATELLITE;
 
+//Satellites in view, assembled from every part of the epoch's GSV sentences
+typedef struct SKY_VIEW_T{
+	SATELLITE SAT[GPS_MAX_SATS];	//Satellite info, COUNT entries used
+	uint32_t UTC;		//fix.UTC when the view was published
+	uint8_t COUNT;		//Number of entries in SAT
+	uint8_t DROPPED;	//Satellites reported that did not fit in SAT
+}SKY_VIEW;
+
 typedef struct GGA_DATA_T{
 	char UTC[11];				//UTC Time
 	char LAT[14];				//Latitude
@@ -101,9 +186,9 @@ typedef struct GSA_DATA_T{
 	char SAT10[3];			// Satellite Used (SV) (channel 10)
 	char SAT11[3];			// Satellite Used (SV) (channel 11)
 	char SAT12[3];			// Satellite Used (SV) (channel 12)
-	char PDOP[4];			// Positional dilution of precision
-	char HDOP[4];			// Horizontal dilution of precision
-	char VDOP[4];			// Vertical Dilution of precision
+	char PDOP[6];			// Positional dilution of precision
+	char HDOP[6];			// Horizontal dilution of precision
+	char VDOP[6];			// Vertical Dilution of precision
 	char CHECKSUM[3];	//checksum
 } GSA_DATA;
 
@@ -111,9 +196,7 @@ typedef struct GSV_DATA_T{
 	int NUMM;					//Number of messages
 	int MESNUM;				//Message number
 	int SATVIEW;				//Satellites in view
-	SATELLITE SAT[15];	//Satellite info
 	char CHECKSUM[3];	//checksum
-
 } GSV_DATA;
 
 typedef struct RMC_DATA_T{
@@ -148,6 +231,109 @@ typedef struct VTG_DATA_T{
 									//E: Estimated mode
 	char CHECKSUM[3];	//checksum
 } VTG_DATA;
+typedef struct GLL_DATA_T{
+	char LAT[12];				//Latitude
+	char NS;						//N/S indicator
+	char LONG[13];			//Longitude
+	char EW;					//E/W indicator
+	char UTC[11];				//UTC Time
+	char STAT;					//Status: A = data valid, V = data not valid
+	char MODE;				//A: Autonomous mode
+									//D: Differential mode
+									//E: Estimated mode
+	char CHECKSUM[3];	//checksum
+} GLL_DATA;
+
+typedef struct ZDA_DATA_T{
+	char UTC[11];				//UTC Time
+	char DAY[3];				//Day, 01 to 31
+	char MONTH[3];			//Month, 01 to 12
+	char YEAR[5];				//Year
+	char ZONEH[4];			//Local zone hours
+	char ZONEM[3];			//Local zone minutes
+	char CHECKSUM[3];	//checksum
+} ZDA_DATA;
+
+typedef struct TXT_DATA_T{
+	char TOTAL[3];			//Number of messages in this transmission
+	char NUM[3];				//Message number
+	char ID[3];					//Text identifier
+	char TEXT[41];				//Text message
+	char CHECKSUM[3];	//checksum
+} TXT_DATA;
+
+typedef enum{
+	CMD_IDLE = 0,	//No command sent yet
+	CMD_SENDING,	//Being written to the port
+	CMD_WAITING,	//Sent, waiting for its $PMTK001
+	CMD_DONE,		//Acknowledged, action succeeded
+	CMD_FAILED,		//Acknowledged as invalid, unsupported or failed, see getCommandFlag()
+	CMD_TIMEOUT		//Not acknowledged after PMTK_RETRIES sends
+} CMD_STATE;
+
+typedef struct ACK_DATA_T{
+	char CMD[4];				//Command number being acknowledged
+	char FLAG;					//0: Invalid command
+									//1: Unsupported command
+									//2: Valid command, action failed
+									//3: Valid command, action succeeded
+	char CHECKSUM[3];	//checksum
+} ACK_DATA;
+
+//Numeric copy of the latest fix, filled in while the sentences are parsed.
+//Members are ordered largest first to keep the padding at the end.
+//RMC and GLL with status V only update the time and date.
+typedef struct FIX_T{
+	int32_t LAT;				//Latitude, 1e-7 degrees, north positive
+	int32_t LON;				//Longitude, 1e-7 degrees, east positive
+	int32_t ALT;				//MSL Altitude, cm
+	uint32_t SPEED;			//Speed over ground, mm/s
+	uint32_t UTC;				//UTC Time, milliseconds since midnight
+	uint16_t COURSE;		//Course over ground, 0.01 degrees from true north
+	uint16_t HDOP;			//HDOP x100
+	uint16_t PDOP;			//PDOP x100
+	uint16_t VDOP;			//VDOP x100
+	uint8_t NUMSAT;		//Number of satellites used
+	uint8_t PFI;				//Position fixed indicator
+	uint8_t DAY;				//UTC date from RMC or ZDA, 0 until one arrives
+	uint8_t MONTH;			//Month, follows DAY
+	uint8_t YEAR;				//Year since 2000, follows MONTH
+} FIX;
+
+typedef enum{
+	PIN_UNKNOWN = 0,	//3DF pin not followed or not telling, isFixed() uses the GGA
+	PIN_NO_FIX,			//3DF pin toggling
+	PIN_FIXED			//3DF pin held low
+} PIN_FIX;
+
+//Local time of a fix from the 1PPS pulse, see attachPPS()
+typedef struct FIX_TIME_T{
+	uint32_t UTC;				//FIX.UTC of the fix
+	uint32_t MICROS;			//micros() at the instant UTC, from the pulse that started its second
+	uint32_t LATENCY;		//Microseconds from that instant until its first sentence was parsed, time in the receive ring included
+	uint16_t PULSES;			//Pulses counted since attachPPS()
+	bool PPS;					//MICROS is from a pulse, otherwise it is when the sentence was parsed and LATENCY is 0
+} FIX_TIME;
+
+typedef enum{
+	N_TIME = 0,	//hhmmss.sss to milliseconds since midnight
+	N_LAT,		//ddmm.mmmm and N/S field to 1e-7 degrees
+	N_LON,		//dddmm.mmmm and E/W field to 1e-7 degrees
+	N_U8,		//Small integer
+	N_DOP,		//Dilution of precision x100
+	N_CM,		//Meters to cm
+	N_KNOTS,		//Knots to mm/s
+	N_KMH,		//km/h to mm/s
+	N_COURSE,		//Degrees to 0.01 degrees
+	N_DATE,		//ddmmyy to DAY, MONTH and YEAR
+	N_YEAR		//yyyy to years since 2000
+} FIX_TYPE;
+
+typedef struct FIX_MAP_T{
+	uint8_t field;	//Index of the data field, 0 is the first after the address
+	uint8_t type;		//FIX_TYPE of the field
+	uint8_t offset;	//offsetof() the destination in FIX
+}FIX_MAP;
 
 
 /*******************
@@ -157,47 +343,242 @@ typedef struct VTG_DATA_T{
 class GPS
 {
 	public:
+	GPS();
 	void GPSinit(HardwareSerial &serialPort, unsigned long baud, uint8_t DF, uint8_t PPS);
 	void GPSinit(HardwareSerial &serialPort, unsigned long baud, uint8_t DF, uint8_t PPS, uint8_t RST);
+#if GPS_USE_ACK
+	unsigned long GPSinitAutoBaud(HardwareSerial &serialPort, unsigned long baud, uint8_t DF, uint8_t PPS);
+#endif
 	
 	NMEA getData(HardwareSerial &serialPort);
+	NMEA feed(uint8_t c);
+	NMEA poll(Stream &stream);
+	NMEA poll();
+	void ingest(HardwareSerial &serialPort);
+	bool receive(uint8_t c);
+	RING_STATS getRxStats();
+	uint16_t processAvailable(uint8_t maxSentences = 255);
+	void setEpochSentences(uint16_t mask);
+	bool isEpochComplete();
 	
 	bool isFixed();	
+#if GPS_USE_STRINGS && GPS_USE_GGA
 	char* getLatitude();
 	char* getLongitude();
-	char* getDate();
+#endif
+	char* getDate(char* out, size_t n);
 	double getAltitude();
-	char* getAltitudeString();
+	char* getAltitudeString(char* out, size_t n);
 	double getTime();
 	int getNumSats();
 	double getPDOP();
 	double getSpeedKnots();
 	double getSpeedKM();
 	double getHeading();
-	SATELLITE* getSatelliteInfo();
+#if GPS_USE_GSV
+	const SATELLITE* getSatelliteInfo();
+	const SKY_VIEW& getSky();
+#endif
+	const FIX& getFix();
+	const FIX& getEpochFix();
+	uint16_t getEpochSequence();
+#if GPS_USE_FILTER
+	void setFilter(FILTER_MODE mode);
+	FIX getFilteredFix();
+#endif
+	NMEA_STATS getStats(NMEA type);
+	void clearStats();
+#if GPS_USE_DF
+	bool attachFixPin();
+	void pollFixPin();
+	PIN_FIX getPinFix();
+#endif
+#if GPS_USE_PPS
+	bool attachPPS();
+	void pollPPS();
+	const FIX_TIME& getFixTime();
+	bool getUTCAt(uint32_t localMicros, uint32_t* utc);
+#endif
 	
-	GGA_DATA getGGA();
-	GSA_DATA getGSA();
-	GSV_DATA getGSV();
-	RMC_DATA getRMC();
-	VTG_DATA getVTG();
+#if GPS_USE_STRINGS
+#if GPS_USE_GGA
+	const GGA_DATA& getGGA();
+#endif
+#if GPS_USE_GSA
+	const GSA_DATA& getGSA();
+#endif
+#if GPS_USE_GSV
+	const GSV_DATA& getGSV();
+#endif
+#if GPS_USE_RMC
+	const RMC_DATA& getRMC();
+#endif
+#if GPS_USE_VTG
+	const VTG_DATA& getVTG();
+#endif
+#if GPS_USE_GLL
+	const GLL_DATA& getGLL();
+#endif
+#if GPS_USE_ZDA
+	const ZDA_DATA& getZDA();
+#endif
+#if GPS_USE_TXT
+	const TXT_DATA& getTXT();
+#endif
+#if GPS_USE_ACK
+	const ACK_DATA& getAck();
+#endif
+#endif
+	uint16_t getTalker();
+	uint16_t getSequence(NMEA type);
+	bool changedSince(NMEA type, uint16_t* seen);
+
+#if GPS_USE_ACK
+	bool sendCommand(uint16_t number, const char* args);
+	CMD_STATE updateCommand();
+	CMD_STATE getCommandState();
+	uint8_t getCommandFlag();
+	bool setUpdateRate(uint16_t ms);
+	bool setSentences(uint16_t mask);
+	bool setBaudrate(unsigned long baud);
+	bool setReferenceTime(uint8_t day, uint8_t month, uint8_t year, uint32_t utc);
+	bool setReferenceLocation(int32_t lat, int32_t lon, int32_t altCm, uint8_t day, uint8_t month, uint8_t year, uint32_t utc);
+#endif
 
 	private:	
 	NMEA chooseMode(char recv[MAX_SIZE]);
-	void formatGGA(char* data_array);
-	void formatGSA(char* data_array);
-	void formatGSV(char* data_array);
-	void formatRMC(char* data_array);
-	void formatVTG(char* data_array);
-	void formatCOORDS(char* coords);
+	uint8_t tokenize(const char* data_array, NMEA_FIELD* fields, NMEA_FIELD* checksum);
+	void formatGGA(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatGSA(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatGSV(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatRMC(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatVTG(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatGLL(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatZDA(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatTXT(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatAck(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields);
+	void formatFields(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields, const FIELD_MAP* map, uint8_t mapSize, void* dest);
+	void countTruncated();
+	bool pushByte(uint8_t c);
+#if GPS_USE_ACK
+	bool resync(HardwareSerial &serPort, unsigned long baud);
+#endif
+#if GPS_USE_DF
+	static void dfISR();
+	void dfEdge(uint8_t level, uint32_t now);
+	void dfSettle(uint32_t now);
+#endif
+#if GPS_USE_PPS
+	static void ppsISR();
+	void updateFixTime();
+	void stampSentence(uint8_t at);
+	uint32_t sentenceArrival(uint8_t at, uint32_t parsed);
+#endif
+	void updateEpoch(NMEA mode);
+	void updateFix(const char* data_array, const NMEA_FIELD* fields, uint8_t numFields, const FIX_MAP* map, uint8_t mapSize);
+#if GPS_USE_GSV
+	void addSatellite(const SATELLITE* sat);
+	void publishSky();
+	void abortSky();
+#endif
 	
+	HardwareSerial* port;		//Port passed to GPSinit(), NULL until then
+	uint8_t ppsPin;				//1PPS pin passed to GPSinit()
+	uint8_t dfPin;				//3DF pin passed to GPSinit()
+	char sentence[MAX_SIZE];	//Sentence being assembled by feed()
+	uint8_t sentenceLen;		//Number of bytes currently in sentence
+	uint8_t checksumCalc;		//XOR of the sentence bytes received so far
+	uint8_t checksumPos;		//Index of the '*' in sentence, 0 until it arrives
+	NMEA_STATS stats[NMEA_TYPES];	//Sentence counts by type
+	uint16_t sequence[NMEA_TYPES];	//Sentences formatted by type, GSV counts whole series
+
+	GPSRingBuffer rxRing;		//Bytes received but not yet parsed
+	uint16_t uartOverruns;	//Times ingest() found the port's buffer overran
+
+	uint32_t epochUTC;			//fix.UTC of the epoch being collected
+	uint16_t epochMask;		//NMEA_BIT()s of the sentences received this epoch
+	uint16_t epochRequired;	//NMEA_BIT()s that make up a complete epoch
+	bool epochDone;				//Set when the epoch completes, cleared by processAvailable()
+	uint16_t epochSequence;	//Epochs completed
+	FIX epochFix;				//fix as it was when the last epoch completed
 
+#if GPS_USE_GSV
+	SKY_VIEW sky[2];			//Published sky view and the one being assembled
+	uint8_t skyFront;			//Index of the published view in sky
+	uint8_t skyEpoch;			//Counts epochs, to age out satellites
+	uint16_t gsvTalker;		//TALKER() of the GSV series being assembled
+	uint8_t gsvNext;			//Next GSV part expected, 0 when no series is open
+#endif
+	bool gsvDone;				//The last GSV completed a series
 
+#if GPS_USE_STRINGS
+#if GPS_USE_GGA
 	GGA_DATA GGAdata;
+#endif
+#if GPS_USE_GSA
 	GSA_DATA GSAdata;
+#endif
+#if GPS_USE_GSV
 	GSV_DATA GSVdata;
+#endif
+#if GPS_USE_RMC
 	RMC_DATA RMCdata;
+#endif
+#if GPS_USE_VTG
 	VTG_DATA VTGdata;
+#endif
+#if GPS_USE_GLL
+	GLL_DATA GLLdata;
+#endif
+#if GPS_USE_ZDA
+	ZDA_DATA ZDAdata;
+#endif
+#if GPS_USE_TXT
+	TXT_DATA TXTdata;
+#endif
+#if GPS_USE_ACK
+	ACK_DATA ACKdata;
+#endif
+#endif
+#if GPS_USE_ACK
+	char command[PMTK_MAX];	//Command sentence being sent, kept for resending
+	uint8_t commandLen;		//Length of command
+	uint8_t commandSent;		//Bytes of command written to the port so far
+	uint16_t commandNumber;	//PMTK number of command, matched against the $PMTK001
+	uint8_t commandTries;		//Times command has been sent
+	uint8_t commandState;		//CMD_STATE of command
+	uint8_t commandFlag;		//FLAG of its $PMTK001, '0' to '3'
+	unsigned long commandTime;	//millis() when command was last written out
+#endif
+#if GPS_USE_PPS
+	volatile uint32_t ppsMicros;	//micros() at the last pulse, written by ppsISR()
+	volatile uint16_t ppsCount;	//Pulses seen, written by ppsISR()
+	uint8_t ppsMode;			//0 off, 1 interrupt, 2 polled by pollPPS()
+	uint8_t ppsLevel;			//Pin level at the last pollPPS()
+	uint16_t ppsUsed;			//ppsCount of the pulse tied to a fix
+	bool ppsTied;				//A pulse has been tied to a fix, ppsUTC and ppsLocal are set
+	uint32_t ppsUTC;			//UTC of the second that pulse started
+	uint32_t ppsLocal;			//ppsMicros of that pulse
+	uint32_t sentenceMicros;	//micros() when the '$' of the current sentence was received
+	volatile uint32_t stampMicros[PPS_STAMPS];	//micros() when a '$' was put in the receive ring
+	volatile uint8_t stampAt[PPS_STAMPS];		//Its index in the ring
+	volatile uint8_t stampHead;	//Next stamp written, producer only
+	volatile uint8_t stampTail;	//Next stamp read, consumer only
+	FIX_TIME fixTime;
+#endif
+#if GPS_USE_DF
+	volatile uint32_t dfEdgeMillis;	//millis() at the last edge of the 3DF pin
+	volatile uint32_t dfToggleMillis;	//millis() when dfStable last changed
+	uint8_t dfMode;				//0 off, 1 interrupt, 2 polled by pollFixPin()
+	volatile uint8_t dfLevel;	//Pin level since dfEdgeMillis
+	volatile uint8_t dfStable;	//Last level that held for DF_DEBOUNCE ms
+	volatile bool dfSeen;		//dfStable has changed since attachFixPin()
+#endif
+	uint16_t talker;			//TALKER() of the last sentence formatted
+	FIX fix;
+#if GPS_USE_FILTER
+	GPSFilter filter;			//Smoothed copy of the GGA positions
+#endif
 	
 };
 
@@ -0,0 +1,92 @@
+/************************************************************************/
+/*																		*/
+/*	PmodGPSConfig.h  Parts of the PmodGPS library to build				*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Each GPS_USE_ setting that is 0 leaves that sentence's parser,		*/
+/*	tables, storage and get functions out of the build. A sentence		*/
+/*	that is not built is counted in getStats(INVALID) like any other	*/
+/*	sentence the library does not decode, and its get functions do		*/
+/*	not exist, so code that still uses them does not compile.			*/
+/*																		*/
+/*	GPS_USE_STRINGS 0 keeps only the numeric FIX (getFix(), isFixed(),	*/
+/*	getNumSats(), ...) and drops the text copy of every sentence		*/
+/*	(getGGA(), getLatitude(), ...), which is most of the RAM.			*/
+/*																		*/
+/*	The defaults below keep the library as it was: the five sentences	*/
+/*	it has always decoded (GGA, GSA, GSV, RMC and VTG) with their text	*/
+/*	structs and get functions, plus the PMTK commands, the filter and	*/
+/*	the 1PPS and 3DF pins. GLL, ZDA and TXT are off until asked for.	*/
+/*																		*/
+/*	The Arduino IDE does not pass a sketch's #defines on to the .cpp	*/
+/*	files, and a setting seen by only some of the files would give		*/
+/*	them different GPS classes. So a PmodGPSUserConfig.h next to this	*/
+/*	file, if there is one, is read by every file before the defaults.	*/
+/*	This folder is also the tracking sketch's, and the one it holds		*/
+/*	turns the text copies and VTG off. Delete it, or define				*/
+/*	GPS_NO_USER_CONFIG as the host tools do, to build with the			*/
+/*	defaults. Other builds can also set any setting on the command		*/
+/*	line, -DGPS_USE_GSV=0 for example. host/size_report.sh prints the	*/
+/*	code and RAM sizes of a few configurations.							*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef PmodGPSConfig_H
+#define PmodGPSConfig_H
+
+#if defined(__has_include) && !defined(GPS_NO_USER_CONFIG)
+#if __has_include("PmodGPSUserConfig.h")
+#include "PmodGPSUserConfig.h"
+#endif
+#endif
+
+#ifndef GPS_USE_GGA
+#define GPS_USE_GGA  1		//Time, position, fix indicator, satellites used, HDOP, altitude
+#endif
+#ifndef GPS_USE_GSA
+#define GPS_USE_GSA  1		//PDOP and VDOP
+#endif
+#ifndef GPS_USE_GSV
+#define GPS_USE_GSV  1		//Satellites in view, getSky()
+#endif
+#ifndef GPS_USE_RMC
+#define GPS_USE_RMC  1		//Time, position, speed, course, date
+#endif
+#ifndef GPS_USE_VTG
+#define GPS_USE_VTG  1		//Speed and course
+#endif
+#ifndef GPS_USE_GLL
+#define GPS_USE_GLL  0		//Time and position
+#endif
+#ifndef GPS_USE_ZDA
+#define GPS_USE_ZDA  0		//Time and date
+#endif
+#ifndef GPS_USE_TXT
+#define GPS_USE_TXT  0		//Text messages
+#endif
+#ifndef GPS_USE_ACK
+#define GPS_USE_ACK  1		//$PMTK001 acknowledgements and sendCommand()
+#endif
+
+#ifndef GPS_USE_STRINGS
+#define GPS_USE_STRINGS  1	//Text copy of each sentence in its XXX_DATA struct
+#endif
+#ifndef GPS_USE_FILTER
+#define GPS_USE_FILTER  1	//Position smoothing, setFilter() and getFilteredFix()
+#endif
+#ifndef GPS_USE_PPS
+#define GPS_USE_PPS  1		//1PPS timestamps of each fix, attachPPS() and getFixTime()
+#endif
+#ifndef GPS_USE_DF
+#define GPS_USE_DF  1		//Fix status from the 3DF pin, attachFixPin() and getPinFix()
+#endif
+
+#endif //PmodGPSConfig_H
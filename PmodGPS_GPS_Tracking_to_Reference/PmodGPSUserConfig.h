@@ -0,0 +1,38 @@
+/************************************************************************/
+/*																		*/
+/*	PmodGPSUserConfig.h  Parts of the PmodGPS library the tracking		*/
+/*						 sketch uses									*/
+/*																		*/
+/************************************************************************/
+/*  Module Description: 												*/
+/*																		*/
+/*	Read by PmodGPSConfig.h ahead of its defaults, so every file of		*/
+/*	the library is built with the same settings. Delete this file to	*/
+/*	build the whole library.											*/
+/*																		*/
+/*	The Uno has 2 KB of RAM. The sketch only reads the numeric FIX and	*/
+/*	the sky view, so the text copy of each sentence (nearly 300 bytes	*/
+/*	of RAM, see host/size_report.sh) is left out to make room for the	*/
+/*	filter, geofence and fix store. The sketch turns VTG off with		*/
+/*	setSentences() and takes the speed from RMC, so its parser is		*/
+/*	left out too.														*/
+/*																		*/
+/************************************************************************/
+/*
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+*/
+
+#ifndef PmodGPSUserConfig_H
+#define PmodGPSUserConfig_H
+
+#ifndef GPS_USE_STRINGS
+#define GPS_USE_STRINGS  0	//The sketch reads FIX, not the XXX_DATA text
+#endif
+#ifndef GPS_USE_VTG
+#define GPS_USE_VTG  0		//The speed comes from RMC
+#endif
+
+#endif //PmodGPSUserConfig_H
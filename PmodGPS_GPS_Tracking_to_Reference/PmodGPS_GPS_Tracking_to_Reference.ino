@@ -12,8 +12,8 @@
 * Description: 
 * This code gathers data from the GPS sensor to report local latitude, longitude, and alittude coordinates 
 *   including Speed, setting a reference location, and differential measurements from local to reference locations. 
-* The code is normalized for the greater Seattle area and must be adjusted to use further than 100km from Seattle.  
-* The code also does not take into account the curvature of the Earth and should not be used for distances greater than 100 km.
+* Distance to the reference uses the model chosen by GEO_MODEL_USED (see GPSgeo.h), GEO_FAST is scaled for the reference latitude
+*   so it works anywhere for local distances, GEO_HAVERSINE or GEO_VINCENTY should be used for distances greater than 100 km.
 * Upon restarting system, the arduino will set the current location as the reference point.
 * Updated data will be compared to the refernce point established on restart.
 * An additional antenna can be purchased to increase signal gain, would also need to purchase a component to solder onto the PmodGPS to attatch antenna
@@ -29,11 +29,30 @@
 
 //Declaration of a serial port
 #include <SoftwareSerial.h>
+//last fix kept across restarts
+#include <EEPROM.h>
 //GPS Pmod header file
 #include "PmodGPS.h"
+//distance and bearing to the reference
+#include "GPSgeo.h"
+//nearest of the stored waypoints
+#include "GPSWaypoints.h"
+//area around the reference
+#include "GPSGeofence.h"
+//text for the LCD without String or float printing
+#include "GPSFormat.h"
+//last good fix saved in EEPROM
+#include "GPSFixStore.h"
+//track of where the system has been, kept in EEPROM
+#include "GPSTrackLog.h"
 
 //constants
-#define PI 3.1415926535897932384626433832795
+#define GEO_MODEL_USED GEO_FAST //GEO_FAST, GEO_HAVERSINE or GEO_VINCENTY
+#define REF_FENCE_RADIUS 50 //meters around the reference counted as being at the reference
+#define FILTER_USED FILTER_KALMAN //FILTER_OFF, FILTER_ALPHA_BETA or FILTER_KALMAN, smooths the position jitter
+#define SAVE_INTERVAL 300000 //milliseconds between saves of the last fix to EEPROM
+#define TRACK_INTERVAL 60000 //milliseconds between points of the track log, a point a second would wear out the EEPROM in weeks
+#define TRACK_BLOCKS 11 //track log blocks at the end of the EEPROM, about an hour of points, the fix store has the rest
 
 //connect tx pin on lcd to pin PWM pin 3 on arduino uno
 SoftwareSerial lcd(2,3); // RX, TX
@@ -52,31 +71,64 @@ typedef enum{
   FIXED
 }STATE;
 
-//GPS data as states declarations for converting from DMS to DD formats of GPS data
+//LCD pages, shown one at a time for PAGE_INTERVAL milliseconds
+//the position pages from PAGE_LATITUDE to PAGE_LAST_POSITION rotate while GPS data keeps being parsed
 typedef enum{
-  DEGREES,
-  MINUTES,
-  SECONDS,
-}GPSDATA;
+  PAGE_NO_SATS,
+  PAGE_SETTING_REF,
+  PAGE_REF_LATITUDE,
+  PAGE_REF_LONGITUDE,
+  PAGE_LATITUDE,
+  PAGE_LONGITUDE,
+  PAGE_DISTANCE,
+  PAGE_BEARING,
+  PAGE_SPEED,
+  PAGE_ALTITUDE,
+  PAGE_WAYPOINT,
+  PAGE_SATS,
+  PAGE_LAST_POSITION = PAGE_SATS
+}PAGE;
+
+#define PAGE_INTERVAL 2000 //milliseconds each page is shown
 
 //create GPS object
 GPS myGPS;
-char* LAT;
-char* LONG;
-NMEA mode;
+uint16_t updated; //sentence types updated by the last processAvailable()
 
 //initialize states
 STATE state=RESTART;
-GPSDATA gpsdata = DEGREES;
+PAGE page=PAGE_NO_SATS;
+unsigned long pageShownAt = 0; //millis() when the current page was drawn
 
 //declare and initialize global variables
-String referenceLatitude,referenceLongitude;
-String currentLatitude, currentLongitude;
-float minutesToDegrees, secondsToDegrees;
-float DDcurrentLatitude, DDcurrentLongitude;
-float DDreferenceLatitude, DDreferenceLongitude;
-float SeattleLatitude = 47.6062; //needed for local linearization
-float directionDegrees, directionMagnitude;
+FIX fix;
+GEO_REF reference; //reference position, set once per restart
+GEO_VECTOR toReference;
+
+//stored waypoints, must be sorted by latitude (south first)
+const WAYPOINT waypointTable[] PROGMEM = {
+  {476097000, -1223422000}, //Pike Place Market
+  {476205000, -1223493000}, //Space Needle
+  {477598000, -1221913000}  //UW Bothell
+};
+GPSWaypoints waypoints;
+WAYPOINT_MATCH nearestWaypoint = {WAYPOINT_NONE};
+
+//geofence around the reference, set up with the reference
+GEOFENCE fenceArray[1];
+GPSGeofence geofence;
+
+//last fix saved in EEPROM, restored as the reference on start up
+GPSFixStore fixStore;
+STORED_FIX savedFix;
+bool aidingPending = false; //savedFix still to be sent to the PmodGPS
+bool sentencesSet = false; //the PmodGPS has been told which sentences to send
+
+//track log, a ring of TRACK_BLOCKS blocks after the fix store, read back with host/trackdump
+GPSTrackLog trackLog;
+uint16_t trackBase; //EEPROM address of the first block
+unsigned long trackedAt = 0; //millis() of the last point logged
+bool tracking = false; //a point has been logged since start up
 
 //starts serial communication with GPS sensor
 //displays to LCD to signify begining of code or system restart
@@ -90,22 +142,95 @@ void setup()
     delay(2000);
     lcd.write("\x1b[j"); 
     lcd.write("\x1b[0h"); 
-    Serial.begin(9600);
-    myGPS.GPSinit(Serial, 9600, _3DFpin, _1PPSpin);
+    //finds the rate the PmodGPS is at (9600 after it loses power) and moves it to 57600
+    myGPS.GPSinitAutoBaud(Serial, 57600, _3DFpin, _1PPSpin);
+    myGPS.attachPPS(); //timestamps each fix from the 1PPS pulse, polled if the pin has no interrupt
+    myGPS.attachFixPin(); //isFixed() follows the 3DF pin, so a lost fix is seen right away instead of at the next GGA
+    myGPS.setFilter(FILTER_USED);
+    waypoints.begin(waypointReadProgmem, waypointTable, sizeof(waypointTable) / sizeof(waypointTable[0]));
+    //use the position saved before the restart as the reference until the PmodGPS has a fix
+    trackBase = EEPROM.length() - TRACK_BLOCKS * TRACK_BLOCK_SIZE;
+    fixStore.begin(eepromRead, eepromWrite, NULL, 0, trackBase);
+    trackLog.begin(trackWrite, NULL, trackNextSequence());
+    if (fixStore.load(&savedFix)){
+      setReference(savedFix.LAT, savedFix.LON);
+      aidingPending = true;
+      state = NOTFIXED;
+      showPage(PAGE_SETTING_REF);
+    }
+}
+
+//EEPROM access for the fix store and track log, update() skips bytes that already hold the value
+//each byte written takes 3.3 ms, so the GPS bytes received meanwhile are moved into the library's ring
+bool eepromRead(void* context, uint16_t address, uint8_t* data, uint8_t size)
+{
+    for (uint8_t i = 0; i < size; i++){
+      data[i] = EEPROM.read(address + i);
+    }
+    return true;
+}
+
+bool eepromWrite(void* context, uint16_t address, const uint8_t* data, uint8_t size)
+{
+    for (uint8_t i = 0; i < size; i++){
+      EEPROM.update(address + i, data[i]);
+      myGPS.ingest(Serial);
+    }
+    return true;
+}
+
+//each block goes to the slot its sequence number picks, so the oldest block is the one overwritten
+bool trackWrite(void* context, const uint8_t* block, uint16_t size)
+{
+    uint16_t sequence = block[2] | (uint16_t)block[3] << 8;
+
+    return eepromWrite(context, trackBase + (sequence % TRACK_BLOCKS) * TRACK_BLOCK_SIZE, block, (uint8_t)size);
+}
+
+//carries on from the newest block already in the EEPROM, so a restart does not overwrite it
+uint16_t trackNextSequence()
+{
+    uint16_t address;
+    uint16_t sequence;
+    uint16_t newest = 0;
+    bool found = false;
+
+    for (uint8_t i = 0; i < TRACK_BLOCKS; i++){
+      address = trackBase + i * TRACK_BLOCK_SIZE;
+      if (EEPROM.read(address) == TRACK_MAGIC){
+        sequence = EEPROM.read(address + 2) | (uint16_t)EEPROM.read(address + 3) << 8;
+        if (!found || (int16_t)(sequence - newest) > 0){
+          newest = sequence;
+          found = true;
+        }
+      }
+    }
+    return found ? newest + 1 : 0;
+}
+
+//move GPS bytes into the library's receive ring between calls to loop()
+//the core's yield() is left alone, other boards' cores use it for their own work,
+//so anything that waits a long time calls myGPS.ingest() itself, as eepromWrite() does
+void serialEvent()
+{
+    myGPS.ingest(Serial);
 }
 
 void loop()
 {
+  //parse every GPS sentence received so far, every time through loop()
+  updated = myGPS.processAvailable();
+  if (updated & NMEA_BIT(GGA)){//If GGAdata was received
+    updateNavigation();
+  }
+  configureGPS();
+
   //State machine for GPS
   switch (state)
   {
     case(RESTART):
-
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("No Sats");
+        showPage(PAGE_NO_SATS);
         state=PREFIXED;
-        delay(2000);       
         break;
 
     //establish connection and set reference point
@@ -113,343 +238,197 @@ void loop()
     //PREFIXED term used only to match existing states theme, it has no added meaning from the author
     //This sets the reference point to where the system is restarted    
     case(PREFIXED): 
-
-      mode = myGPS.getData(Serial);//Receive data from GPS
-      if (mode == GGA){//If GGAdata was received
-
-        //print to LCD: "Setting Reference"
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("# of Sats: ");lcd.print(myGPS.getNumSats());
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h");
-        lcd.print("Setting Reference");
-        delay(2000); //delays used to keep LCD prints long enough for user to read
-
-        //set reference latitude as current lattitude at reset
-        //myGPS.getLatitude() returns a string in Degrees-Minutes_Seconds format
-        referenceLatitude = myGPS.getLatitude();
-        
-        //convert string data to float in Decimal-Degrees format 
-        DDreferenceLatitude = convertDMStoDDlatitude(referenceLatitude);
-
-        //set reference longitude as current longitude at reset
-        //myGPS.getLongitude() returns a string in Degrees-Minutes_Seconds format
-        referenceLongitude = myGPS.getLongitude();
-        
-        //convert string data to float in Decimal-Degrees format 
-        DDreferenceLongitude = convertDMStoDDlongitude(referenceLongitude);
-
-        //display reference coordinates to LCD
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("Reference Latitude: "); lcd.print(DDreferenceLatitude, 6);
-        delay(2000);
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        //longitude around Seattle is a negative number but conversion function omits this 
-        lcd.print("Reference Longitude: -"); lcd.print(DDreferenceLongitude, 6);
-        delay(2000);
-
-        //if a reference point has been set, change state, otherwise repeat this state until reference is set
-        if (DDreferenceLongitude != 0 && DDreferenceLatitude != 0){
+      if (updated & NMEA_BIT(GGA)){//If GGAdata was received
+        fix = myGPS.getFix();
+        //if a position has been received, set it as the reference and change state,
+        //otherwise repeat this state until reference is set
+        if (fix.LAT != 0 && fix.LON != 0){
+          setReference(fix.LAT, fix.LON);
+          updateNavigation();
           state = NOTFIXED;
-          }
+          showPage(PAGE_SETTING_REF);//reference pages are shown once, then the position pages rotate
         }
-        
-        break; 
-      
-        
+      }
+      break; 
+
     case(NOTFIXED)://Look for satellites, display how many the GPS is connected to
-      mode = myGPS.getData(Serial);//Receive data from GPS
-      if (mode == GGA){//If GGAdata was received
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("# of Sats: ");lcd.print(myGPS.getNumSats());lcd.print(" Position: Not Fixed");
-        delay(2000);
-
-        //get current latitude and convert to decimal degrees format
-        currentLatitude = myGPS.getLatitude();
-        DDcurrentLatitude = convertDMStoDDlatitude(currentLatitude);
-
-        //get current longitude and convert to decimal degrees format
-        currentLongitude = myGPS.getLongitude();
-        DDcurrentLongitude = convertDMStoDDlongitude(currentLongitude);
-
-        //print data to LCD
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("Latitude: ");lcd.print(DDcurrentLatitude, 6);lcd.print(" Deg ");     
-        delay(2000);
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("Longitude: -");lcd.print(DDcurrentLongitude, 6);lcd.print(" Deg ");
-        delay(2000);
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        directionMagnitude = spaceBetween(DDcurrentLongitude, DDreferenceLongitude, DDcurrentLatitude, DDreferenceLatitude);
-        lcd.print("Distance to Ref: ");lcd.print(directionMagnitude);
-        lcd.print(" Meters");
-        delay(2000);
-        directionDegrees = directionToDegrees(DDcurrentLongitude, DDreferenceLongitude, DDcurrentLatitude, DDreferenceLatitude);
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("Angle to Ref: ");lcd.print(directionDegrees);
-        lcd.print(" Deg ");lcd.print(directionToCompass(directionDegrees));
-        delay(2000);
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("Speed: ");lcd.print(myGPS.getSpeedKM(), 3);lcd.print(" km/hr");
-        delay(2000); 
-        lcd.write("\x1b[j"); 
-        lcd.write("\x1b[0h"); 
-        lcd.print("Altitude: ");lcd.print(myGPS.getAltitude());lcd.print(" meters");      
-        delay(2000);
-        
-        if (myGPS.isFixed()){//When it is fixed, continue
-          state=FIXED;
-        }
+      if (myGPS.isFixed()){//When it is fixed, continue
+        state=FIXED;
       }
-        break;
+      break;
+
     case(FIXED): //I am still unsure what Posisition Fixed Indicator (PFI) is used for / significance
                  //this code didn't seem to perform differently bewteen NOTFIXED and FIXED
-        if(myGPS.isFixed()){//Update data while there is a position fix
-          mode = myGPS.getData(Serial);
-          if (mode == GGA){//If GGAdata was received
-          
-        //get current latitude and convert to decimal degrees format
-          currentLatitude = myGPS.getLatitude();
-         DDcurrentLatitude = convertDMStoDDlatitude(currentLatitude);
-        
-        //get current longitude and convert to decimal degrees format
-          currentLongitude = myGPS.getLongitude();
-          DDcurrentLongitude = convertDMStoDDlongitude(currentLongitude);
-
-              //print data to LCD
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("Latitude: ");lcd.print(DDcurrentLatitude, 6);lcd.print(" Deg ");
-              delay(2000);
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("Longitude: -");lcd.print(DDcurrentLongitude, 6);lcd.print(" Deg ");
-              delay(2000);
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("Altitude: ");lcd.print(myGPS.getAltitude());lcd.print(" meters");
-              delay(2000);
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("# of Sats: ");lcd.print(myGPS.getNumSats());lcd.print(" Position: Fixed");
-              delay(2000);
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("\n");
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("Distance to Ref: ");lcd.print(spaceBetween(DDcurrentLongitude, DDreferenceLongitude, DDcurrentLatitude, DDreferenceLatitude));
-              lcd.print(" Meters");
-              delay(2000);
-              directionDegrees = directionToDegrees(DDcurrentLongitude, DDreferenceLongitude, DDcurrentLatitude, DDreferenceLatitude);
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("Angle to Ref: ");lcd.print(directionDegrees);
-              lcd.print(" Deg ");lcd.print(directionToCompass(directionDegrees));
-              delay(2000);
-              lcd.write("\x1b[j"); 
-              lcd.write("\x1b[0h"); 
-              lcd.print("Speed: ");lcd.print(myGPS.getSpeedKM(), 3);lcd.print(" km/hr");
-              delay(2000); 
-          }
-        }
-        else {
-          state=RESTART;//If PFI = 0, re-enter connecting state
-        }
+      //isFixed() follows the debounced 3DF pin, so a lost fix is acted on without waiting for the next GGA
+      if (!myGPS.isFixed()){
+        state=RESTART;//If PFI = 0, re-enter connecting state
+      }
       break;
   }
-}
-
-// functions for loop code, could go into header file
 
+  //move to the next page once the current one has been shown long enough
+  if (millis() - pageShownAt >= PAGE_INTERVAL){
+    showPage(nextPage(page));
+  }
+}
 
 ///**************************************************/
-///* function: convertDMStoDDlatitude                                                */                                */
-///* input: String
-///* output: float                                  
-///* description: parses string for numerical values
-///*   gps coordinates captured in degrees minutes seconds mode
-///*   converts DMS format to Decimal Degrees format for calcualtions
-///*   convert by dividing minutes data by 60 and seconds data by 3600 then summing each with the degrees data
-///*   1 degree is 60 minutes and there are 60 seconds in each minute
+///* function: updateNavigation
+///* input: none
+///* output: none
+///* description: updates current position, distance and direction to the reference and the nearest waypoint
+///*   from the latest filtered fix, saves it to EEPROM every SAVE_INTERVAL and logs it every TRACK_INTERVAL while fixed
+///*   called for every GGA sentence so the values are current whenever a page is drawn
 ///**************************************************/
-float convertDMStoDDlatitude(String lat){
-          float coordDegreesLat = 0.00;
-          String inStringLat = "";
-
-            switch (gpsdata) {
-              
-              case (DEGREES):
-                inStringLat += lat.substring(0,2); //first two chars are degrees
-                coordDegreesLat += inStringLat.toFloat(); //convert to float, add to decimal degrees value
-                inStringLat = "";//clear temp string
-                gpsdata = MINUTES;//move to parse next part of string
-               
-               case (MINUTES):
-                inStringLat += lat.substring(3,5); //skip char, next two are minutes
-                minutesToDegrees = (inStringLat.toFloat() / 60);  //convert to float
-                coordDegreesLat += minutesToDegrees; //add to decimal degrees value
-                inStringLat = "";//clear temp string
-                gpsdata = SECONDS;//move to parse next part of string
-               
-               case (SECONDS):
-                inStringLat += lat.substring(6,11); //skip char, last five are seconds with a decimal between two integers
-                secondsToDegrees = (inStringLat.toFloat() / 3600);//convert to float
-                coordDegreesLat += secondsToDegrees; //add to decimal degrees value
-                inStringLat = "";//clear temp string
-                gpsdata = DEGREES;//move to parse next part of string
-            }
- return coordDegreesLat;
+void updateNavigation(){
+  STORED_FIX lastFix;
+
+  fix = myGPS.getFilteredFix();
+  if (myGPS.isFixed()){
+    lastFix.LAT = fix.LAT;
+    lastFix.LON = fix.LON;
+    lastFix.ALT = fix.ALT;
+    lastFix.UTC = fix.UTC;
+    lastFix.DAY = fix.DAY;
+    lastFix.MONTH = fix.MONTH;
+    lastFix.YEAR = fix.YEAR;
+    fixStore.update(&lastFix, millis(), SAVE_INTERVAL);
+    if (!tracking || millis() - trackedAt >= TRACK_INTERVAL){
+      TRACK_POINT point = {fix.LAT, fix.LON, fix.UTC, fix.ALT, fix.SPEED};
+      trackLog.append(&point);
+      trackedAt = millis();
+      tracking = true;
+    }
+  }
+  if (state == NOTFIXED || state == FIXED){
+    geoInverse(&reference, fix.LAT, fix.LON, GEO_MODEL_USED, &toReference);
+    geofence.update(fix.LAT, fix.LON, millis());
+  }
+  if (waypoints.nearest(fix.LAT, fix.LON, &nearestWaypoint, 1, GEO_MODEL_USED) == 0){
+    nearestWaypoint.INDEX = WAYPOINT_NONE;
+  }
 }
 
 ///**************************************************/
-///* function: convertDMStoDDlongitude                                                */                                */
-///* input: String
-///* output: float                                  
-///* description: parses string for numerical values
-///*   gps coordinates captured in degrees minutes seconds mode
-///*   converts DMS format to Decimal Degrees format for calcualtions
-///*   convert by dividing minutes data by 60 and seconds data by 3600 then summing each with the degrees data
-///*   1 degree is 60 minutes and there are 60 seconds in each minute
-///*   NOTE: seconds to degrees accuracy improved when normalizing difference in longitude degrees to Seattle area
+///* function: setReference
+///* input: int32_t lat, lon -> reference position, 1e-7 degrees
+///* output: none
+///* description: sets the reference that distance and bearing are measured to and the geofence around it
 ///**************************************************/
-float convertDMStoDDlongitude(String longit){
-    
-    float coordDegreesLong = 0.0;
-    String inStringLong = "";
-  
-            switch (gpsdata) {
-              
-              case (DEGREES): //first 3 characters are degrees
-                inStringLong += longit.substring(0,3); //parse string
-               coordDegreesLong += inStringLong.toFloat(); //convert to float, add to decimal degrees value
-               inStringLong = ""; //clear temp string
-               gpsdata = MINUTES; //move to parse next part of string
-               
-               case (MINUTES): //skip a char then next two are minutes
-                inStringLong += longit.substring(4,6); //parse string
-               minutesToDegrees = (inStringLong.toFloat() / 60);  //convert to float 
-               coordDegreesLong += minutesToDegrees; //add to decimal degrees value
-               inStringLong = ""; //clear temp string
-               gpsdata = SECONDS;//move to parse next part of string
-               
-               case (SECONDS): //skip a char then last five are seconds with a decimal in the middle of four integers
-                inStringLong += longit.substring(7,12); //parse string
-                secondsToDegrees = cos(SeattleLatitude*PI/180)*(inStringLong.toFloat() / 3600); //convert to float
-                coordDegreesLong += secondsToDegrees; //add to decimal degrees value
-                inStringLong = ""; //clear temp string
-                gpsdata = DEGREES; //reset to beginning of string state for next function call
-            }
- return coordDegreesLong;
-  }
+void setReference(int32_t lat, int32_t lon){
+  geoSetReference(&reference, lat, lon);
+  geofence.begin(fenceArray, 1, lat, lon);
+  geofence.addCircle(lat, lon, REF_FENCE_RADIUS);
+}
 
 ///**************************************************/
-///* function: spaceBetween                                                                               */
-///* input: 4 floats -> longitude and latitude of current posistion and reference posistion
-///* output: float                                  
-///* description: takes gps coordinates of two locations and calculates distance between them in meters 
+///* function: configureGPS
+///* input: none
+///* output: none
+///* description: sends the PmodGPS its settings, one command at a time once the one before has been answered
+///*   RMC carries the speed as well, so VTG is turned off to leave more of the port for the other sentences
+///*   the saved position is sent as aiding once the PmodGPS reports a date near the saved one,
+///*   the Uno has no clock of its own and a wrong time would slow the start instead of helping
 ///**************************************************/
-float spaceBetween(float longitudeLocal, float longitudeOther, float latitudeLocal, float latitudeOther){
-      float longDiff = longitudeLocal - longitudeOther;
-      float latDiff = latitudeLocal - latitudeOther;
-      float longMeterPerDeg = 85390; //Seattle area distance between degrees longitude
-      float latMeterPerDeg = 111030; //Seattle area distance between degrees latitude
-      float longMeters = longDiff*longMeterPerDeg; //convert differnce of longitude degrees to meters
-      float latMeters = latDiff*latMeterPerDeg;//convert differnce of latitude degrees to meters
-      float directionMag = sqrt(longMeters*longMeters + latMeters*latMeters); //pythagorean distance formula
-  return directionMag;
-}
+void configureGPS(){
+  CMD_STATE command = myGPS.getCommandState();
+  const FIX& now = myGPS.getFix();
 
+  if (command == CMD_SENDING || command == CMD_WAITING){
+    return;
+  }
+  if (!sentencesSet){
+    sentencesSet = myGPS.setSentences(NMEA_BIT(GGA) | NMEA_BIT(GSA) | NMEA_BIT(GSV) | NMEA_BIT(RMC));
+  }
+  else if (aidingPending && myGPS.isFixed()){
+    aidingPending = false; //too late to help
+  }
+  else if (aidingPending && now.DAY != 0 && (now.YEAR == savedFix.YEAR || now.YEAR == savedFix.YEAR + 1)){
+    aidingPending = !myGPS.setReferenceLocation(savedFix.LAT, savedFix.LON, savedFix.ALT, now.DAY, now.MONTH, now.YEAR, now.UTC);
+  }
+}
 
 ///**************************************************/
-///* function: directionToDegrees                                                                               */
-///* input: 4 floats -> longitude and latitude of current posistion and reference posistion
-///* output: float                                  
-///* description: determine direction to reference from local coordinates in degrees 
+///* function: nextPage
+///* input: PAGE -> page being shown
+///* output: PAGE
+///* description: picks the page shown after the current one
+///*   before the reference is set only the satellite count is shown
+///*   the reference pages are shown once, then the position pages rotate
 ///**************************************************/
-float directionToDegrees(float longitudeLocal, float longitudeOther, float latitudeLocal, float latitudeOther){
-      float  longDiffTemp = 0;
-      float  latDiffTemp = 0;
-      float  longDiff = 0;
-      float  latDiff = 0;
-      float directionToDegrees = 0.0;
-      int posLong = 0;
-      int posLat = 0;
-
-      latDiffTemp = (latitudeOther - latitudeLocal); // y axis
-      longDiffTemp = (longitudeOther - longitudeLocal);// x axis
-
-      //determine if difference in longitude and latitude is positive or negative
-      //this helps determine what quadrant the angle lies in
-      if (longDiff > 0){posLong = 1;}
-      if (latDiff > 0){posLat = 1;}
-
-      //converts negative value to positive for to ease calculation
-      if (longDiff < 0){longDiff = -1*longDiff;}
-      if (latDiff < 0){latDiff = -1*latDiff;}
-
-      //calculate angle 
-      float directionToDegreesTemp = atan2(latDiff, longDiff) * (180 / PI);
-
-      //determine true angle by determining which quadrant then compensating appropriately from acrtan return
-      if (posLong){
-        if (posLat){ //quad 1
-          directionToDegrees = directionToDegreesTemp;
-          }
-        else{ //quad 4
-          directionToDegrees = 2*PI + directionToDegreesTemp;
-          }
-        }   
-      else{ 
-          if (posLat){//quad 2 
-          directionToDegrees = PI - directionToDegreesTemp;
-          }
-          else{ //quad 3
-          directionToDegrees = PI + directionToDegreesTemp;
-          }
-        }  
- return directionToDegrees;
+PAGE nextPage(PAGE current){
+  if (state == RESTART || state == PREFIXED){
+    return PAGE_SATS;
+  }
+  if (current == PAGE_NO_SATS || current >= PAGE_LAST_POSITION){
+    return PAGE_LATITUDE;
+  }
+  return (PAGE)(current + 1);
 }
 
-
 ///**************************************************/
-///* function: directionToCompass                                                                               */
-///* input: float
-///* output: float                                  
-///* description: determine cardinal direction to reference from direction degrees 
-///*      set up such that East is zero degrees and degrees increase counter clockwise to simplify
-///*       a more correct approach would have North be zero degrees and report a bearing degree to East or West
-///*       might be good to implement some epsilon value for N, S, E, W directions so the degree value doesn't need to be exact
+///* function: showPage
+///* input: PAGE -> page to draw
+///* output: none
+///* description: draws one page on the LCD from the most recent data and restarts the page timer
 ///**************************************************/
-String directionToCompass(float directionDegrees){
-    
-    String directionToCompass = "";
-    
-    if (directionDegrees == 0.0 || directionDegrees == 360.0){directionToCompass = "E";}
-    else if (directionDegrees > 0.0 && directionDegrees < 30.0){directionToCompass = "NEE";}
-    else if (directionDegrees >= 30.0 && directionDegrees < 60.0){directionToCompass = "NE";}
-    else if (directionDegrees >= 60.0 && directionDegrees < 90.0){directionToCompass = "NNE";}
-    else if (directionDegrees = 90.0){directionToCompass = "N";}
-    else if (directionDegrees > 90.0 && directionDegrees < 120.0){directionToCompass = "NNW";}
-    else if (directionDegrees >= 120.0 && directionDegrees < 150.0){directionToCompass = "NW";}
-    else if (directionDegrees >= 150.0 && directionDegrees < 180.0){directionToCompass = "NWW";}
-    else if (directionDegrees = 180.0){directionToCompass = "W";}
-    else if (directionDegrees > 180.0 && directionDegrees < 210.0){directionToCompass = "SWW";}
-    else if (directionDegrees >= 210.0 && directionDegrees < 240.0){directionToCompass = "SW";}
-    else if (directionDegrees >= 240.0 && directionDegrees < 270.0){directionToCompass = "SSW";}
-    else if (directionDegrees = 270.0){directionToCompass = "S";}
-    else if (directionDegrees > 180.0 && directionDegrees < 210.0){directionToCompass = "SSE";}
-    else if (directionDegrees >= 210.0 && directionDegrees < 240.0){directionToCompass = "SE";}
-    else if (directionDegrees >= 240.0 && directionDegrees < 270.0){directionToCompass = "SEE";}
- 
- return directionToCompass;
-}
+void showPage(PAGE newPage){
+  char compass[4];
+  char text[FORMAT_MAX];
+
+  page = newPage;
+  pageShownAt = millis();
+
+  lcd.write("\x1b[j"); 
+  lcd.write("\x1b[0h"); 
+  switch (page)
+  {
+    case(PAGE_NO_SATS):
+      lcd.print("No Sats");
+      break;
+    case(PAGE_SETTING_REF):
+      lcd.print("Setting Reference");
+      break;
+    case(PAGE_REF_LATITUDE):
+      lcd.print("Reference Latitude: "); lcd.print(formatDegrees(text, sizeof(text), reference.LAT, 6));
+      break;
+    case(PAGE_REF_LONGITUDE):
+      lcd.print("Reference Longitude: "); lcd.print(formatDegrees(text, sizeof(text), reference.LON, 6));
+      break;
+    case(PAGE_LATITUDE):
+      lcd.print("Latitude: ");lcd.print(formatDegrees(text, sizeof(text), fix.LAT, 6));lcd.print(" Deg ");
+      break;
+    case(PAGE_LONGITUDE):
+      lcd.print("Longitude: ");lcd.print(formatDegrees(text, sizeof(text), fix.LON, 6));lcd.print(" Deg ");
+      break;
+    case(PAGE_DISTANCE):
+      lcd.print("Distance to Ref: ");lcd.print(formatFixed(text, sizeof(text), (int32_t)(toReference.DISTANCE * 100), 2));
+      lcd.print(" Meters");
+      if (geofence.getState(0) == FENCE_INSIDE){lcd.print(" At Ref");}
+      break;
+    case(PAGE_BEARING): //degrees clockwise from true north
+      lcd.print("Angle to Ref: ");lcd.print(formatFixed(text, sizeof(text), (int32_t)(toReference.BEARING * 100), 2));
+      lcd.print(" Deg ");lcd.print(geoCompassName(geoCompassIndex(toReference.BEARING), compass));
+      break;
+    case(PAGE_SPEED):
+      lcd.print("Speed: ");lcd.print(formatFixed(text, sizeof(text), (myGPS.getFix().SPEED * 36 + 5) / 10, 3));//mm/s to m/h
+      lcd.print(" km/hr");
+      break;
+    case(PAGE_ALTITUDE):
+      lcd.print("Altitude: ");lcd.print(formatFixed(text, sizeof(text), myGPS.getFix().ALT, 2));lcd.print(" meters");
+      break;
+    case(PAGE_WAYPOINT):
+      if (nearestWaypoint.INDEX != WAYPOINT_NONE){
+        lcd.print("Waypoint ");lcd.print(nearestWaypoint.INDEX);lcd.print(": ");
+        lcd.print(formatFixed(text, sizeof(text), (int32_t)(nearestWaypoint.VECTOR.DISTANCE * 100), 2));lcd.print(" m ");
+        lcd.print(geoCompassName(geoCompassIndex(nearestWaypoint.VECTOR.BEARING), compass));
+      }
+      break;
+    case(PAGE_SATS):
+      lcd.print("# of Sats: ");lcd.print(myGPS.getNumSats());
+      lcd.print(" of ");lcd.print(myGPS.getSky().COUNT);
+      if (state == FIXED){lcd.print(" Position: Fixed");}
+      else if (state == NOTFIXED){lcd.print(" Position: Not Fixed");}
+      break;
+  }
+}
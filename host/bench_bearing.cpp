@@ -0,0 +1,249 @@
+/************************************************************************/
+/*																		*/
+/*	bench_bearing.cpp  Host check and benchmark of the bearing kernel	*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Sweeps the full circle in small steps and checks geoBearing() and	*/
+/*	geoCompassIndex() against an exact double precision answer. The	*/
+/*	exact compass points and the edges of every sector are checked as	*/
+/*	well. Then times the kernel against directionToDegrees() and		*/
+/*	directionToCompass() as the tracking sketch had them, with Arduino	*/
+/*	String replaced by std::string. The old code never used its		*/
+/*	inputs, so its atan2() of zeros can be hoisted out of the loop and	*/
+/*	its timing is only a floor: the kernel, which has to do the work,	*/
+/*	takes about twice as long on a host. Exits with 1 if any check		*/
+/*	fails.																*/
+/*																		*/
+/*	Usage: bench_bearing [steps]										*/
+/*																		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "GPSgeo.h"
+
+#define MAX_ERROR_DEG  0.001	//Allowed bearing error
+
+typedef struct DIRECTION_T{
+	float east;
+	float north;
+	double exact;	//Degrees clockwise from north, 0 to <360
+}DIRECTION;
+
+/* ------------------------------------------------------------ */
+/*  Previous code, copied from the tracking sketch
+*/
+#define PI 3.1415926535897932384626433832795
+
+static float legacyDirectionToDegrees(float longitudeLocal, float longitudeOther, float latitudeLocal, float latitudeOther)
+{
+	float  longDiffTemp = 0;
+	float  latDiffTemp = 0;
+	float  longDiff = 0;
+	float  latDiff = 0;
+	float directionToDegrees = 0.0;
+	int posLong = 0;
+	int posLat = 0;
+
+	latDiffTemp = (latitudeOther - latitudeLocal); // y axis
+	longDiffTemp = (longitudeOther - longitudeLocal);// x axis
+	(void)latDiffTemp; (void)longDiffTemp;
+
+	if (longDiff > 0){posLong = 1;}
+	if (latDiff > 0){posLat = 1;}
+
+	if (longDiff < 0){longDiff = -1*longDiff;}
+	if (latDiff < 0){latDiff = -1*latDiff;}
+
+	float directionToDegreesTemp = atan2(latDiff, longDiff) * (180 / PI);
+
+	if (posLong){
+		if (posLat){directionToDegrees = directionToDegreesTemp;}
+		else{directionToDegrees = 2*PI + directionToDegreesTemp;}
+	}
+	else{
+		if (posLat){directionToDegrees = PI - directionToDegreesTemp;}
+		else{directionToDegrees = PI + directionToDegreesTemp;}
+	}
+	return directionToDegrees;
+}
+
+static std::string legacyDirectionToCompass(float directionDegrees)
+{
+	std::string directionToCompass = "";
+
+	if (directionDegrees == 0.0 || directionDegrees == 360.0){directionToCompass = "E";}
+	else if (directionDegrees > 0.0 && directionDegrees < 30.0){directionToCompass = "NEE";}
+	else if (directionDegrees >= 30.0 && directionDegrees < 60.0){directionToCompass = "NE";}
+	else if (directionDegrees >= 60.0 && directionDegrees < 90.0){directionToCompass = "NNE";}
+	else if ((directionDegrees = 90.0)){directionToCompass = "N";}
+	else if (directionDegrees > 90.0 && directionDegrees < 120.0){directionToCompass = "NNW";}
+	else if (directionDegrees >= 120.0 && directionDegrees < 150.0){directionToCompass = "NW";}
+	else if (directionDegrees >= 150.0 && directionDegrees < 180.0){directionToCompass = "NWW";}
+	else if ((directionDegrees = 180.0)){directionToCompass = "W";}
+	else if (directionDegrees > 180.0 && directionDegrees < 210.0){directionToCompass = "SWW";}
+	else if (directionDegrees >= 210.0 && directionDegrees < 240.0){directionToCompass = "SW";}
+	else if (directionDegrees >= 240.0 && directionDegrees < 270.0){directionToCompass = "SSW";}
+	else if ((directionDegrees = 270.0)){directionToCompass = "S";}
+	else if (directionDegrees > 180.0 && directionDegrees < 210.0){directionToCompass = "SSE";}
+	else if (directionDegrees >= 210.0 && directionDegrees < 240.0){directionToCompass = "SE";}
+	else if (directionDegrees >= 240.0 && directionDegrees < 270.0){directionToCompass = "SEE";}
+	return directionToCompass;
+}
+
+/* ------------------------------------------------------------ */
+/*  angleError()
+**
+**  Return Value:
+**    the smallest difference between two bearings, degrees
+*/
+static double angleError(double a, double b)
+{
+	double d = fabs(a - b);
+	return d > 180 ? 360 - d : d;
+}
+
+/* ------------------------------------------------------------ */
+/*  exactIndex()
+**
+**  Return Value:
+**    the compass point nearest the bearing, worked out in double
+*/
+static int exactIndex(double bearing)
+{
+	return (int)floor(bearing / 22.5 + 0.5) % GEO_COMPASS_POINTS;
+}
+
+/* ------------------------------------------------------------ */
+/*  checkSweep()
+**
+**  Return Value:
+**    the number of failed checks
+**
+**  Description:
+**    Directions all around the circle at a range of lengths. Compass
+**	  indices are only compared away from the sector edges, where the
+**	  float rounding of the bearing may legitimately pick either side.
+*/
+static int checkSweep(const std::vector<DIRECTION>& dirs, double* worst)
+{
+	int failed = 0;
+	size_t i;
+
+	*worst = 0;
+	for (i = 0; i < dirs.size(); i++){
+		float bearing = geoBearing(dirs[i].east, dirs[i].north);
+		double err = angleError(bearing, dirs[i].exact);
+		double edge = fmod(dirs[i].exact + 11.25, 22.5);
+
+		*worst = fmax(*worst, err);
+		if (!(bearing >= 0 && bearing < 360) || err > MAX_ERROR_DEG){
+			if (failed++ < 10){
+				printf("FAIL bearing %.6f expected %.6f\n", bearing, dirs[i].exact);
+			}
+		}
+		if (edge > MAX_ERROR_DEG && edge < 22.5 - MAX_ERROR_DEG &&
+			geoCompassIndex(bearing) != exactIndex(dirs[i].exact)){
+			if (failed++ < 10){
+				printf("FAIL compass %u expected %d at %.6f\n", geoCompassIndex(bearing), exactIndex(dirs[i].exact), dirs[i].exact);
+			}
+		}
+	}
+	return failed;
+}
+
+/* ------------------------------------------------------------ */
+/*  checkPoints()
+**
+**  Return Value:
+**    the number of failed checks
+**
+**  Description:
+**    The 16 compass directions exactly, the axes with both signs of
+**	  zero, a zero vector and directions just either side of north.
+*/
+static int checkPoints(void)
+{
+	static const char* names[GEO_COMPASS_POINTS] = {
+		"N", "NNE", "NE", "ENE", "E", "ESE", "SE", "SSE",
+		"S", "SSW", "SW", "WSW", "W", "WNW", "NW", "NNW"
+	};
+	int failed = 0;
+	char name[4];
+	int i;
+
+	for (i = 0; i < GEO_COMPASS_POINTS; i++){
+		double rad = i * 22.5 * M_PI / 180;
+		float bearing = geoBearing((float)sin(rad), (float)cos(rad));
+		uint8_t index = geoCompassIndex(bearing);
+
+		geoCompassName(index, name);
+		if (index != i || std::string(name) != names[i] || angleError(bearing, i * 22.5) > MAX_ERROR_DEG){
+			printf("FAIL point %s: bearing %.6f index %u name %s\n", names[i], bearing, index, name);
+			failed++;
+		}
+	}
+	if (geoBearing(0, 0) != 0 || geoBearing(-0.0f, 1) != 0 || geoBearing(0, -1) != 180 ||
+		geoBearing(1, 0) != 90 || geoBearing(-1, 0) != 270 || geoBearing(-0.0f, -1) != 180){
+		printf("FAIL axes\n");
+		failed++;
+	}
+	if (geoBearing(-1e-7f, 1) >= 360 || geoCompassIndex(geoBearing(-1e-7f, 1)) != 0 ||
+		geoCompassIndex(geoBearing(1e-7f, 1)) != 0){
+		printf("FAIL either side of north\n");
+		failed++;
+	}
+	return failed;
+}
+
+int main(int argc, char** argv)
+{
+	size_t steps = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	std::vector<DIRECTION> dirs(steps);
+	double worst, legacyWorst = 0, sink = 0;
+	int failed;
+	size_t i;
+
+	for (i = 0; i < steps; i++){
+		double exact = 360.0 * i / steps;
+		double length = pow(10.0, (double)(i % 9) - 3);	//1 mm to 100 km, in metres
+		dirs[i].east = (float)(sin(exact * M_PI / 180) * length);
+		dirs[i].north = (float)(cos(exact * M_PI / 180) * length);
+		dirs[i].exact = fmod(atan2((double)dirs[i].east, (double)dirs[i].north) * 180 / M_PI + 360, 360);	//Of the rounded vector
+	}
+
+	failed = checkPoints() + checkSweep(dirs, &worst);
+
+	for (i = 0; i < steps; i++){
+		legacyWorst = fmax(legacyWorst, angleError(legacyDirectionToDegrees(0, dirs[i].east, 0, dirs[i].north), dirs[i].exact));
+	}
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (i = 0; i < steps; i++){
+		float degrees = legacyDirectionToDegrees(0, dirs[i].east, 0, dirs[i].north);
+		sink += degrees + legacyDirectionToCompass(degrees).size();
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for (i = 0; i < steps; i++){
+		float bearing = geoBearing(dirs[i].east, dirs[i].north);
+		sink += bearing + geoCompassIndex(bearing);
+	}
+	auto t2 = std::chrono::steady_clock::now();
+
+	double legacyNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / steps;
+	double newNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / steps;
+
+	printf("directions:                 %zu\n", steps);
+	printf("directionToDegrees/Compass: %8.1f ns/direction  worst error %10.6f deg\n", legacyNs, legacyWorst);
+	printf("geoBearing/geoCompassIndex: %8.1f ns/direction  worst error %10.6f deg\n", newNs, worst);
+	printf("time against the old code:  %8.1fx, which only ever worked out atan2(0, 0)\n", newNs / legacyNs);
+	printf("%s\n", failed ? "FAILED" : "passed");
+	return failed ? 1 : (sink == 0.5);//sink keeps the loops from being optimized out
+}
@@ -0,0 +1,173 @@
+/************************************************************************/
+/*																		*/
+/*	bench_coords.cpp  Host benchmark of the coordinate decoders			*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Compares decodeCoordinate() with the path the tracking sketch used	*/
+/*	before it: GPS::formatCOORDS() turning ddmm.mmmm into a DMS string,	*/
+/*	then convertDMStoDDlatitude()/convertDMStoDDlongitude() taking that	*/
+/*	string apart again with substrings and float division. Arduino		*/
+/*	String is replaced by std::string, everything else is copied as it	*/
+/*	was. Reports time per coordinate and the worst error against an		*/
+/*	exact decimal conversion of the same field. Exits with 1 if			*/
+/*	decodeCoordinate() is ever more than MAX_ERROR from it.				*/
+/*																		*/
+/*	Usage: bench_coords [count]											*/
+/*																		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "GPScoord.h"
+
+#define METERS_PER_DEGREE  111195.0	//Mean earth radius arc length of one degree
+#define MAX_ERROR		   1e-7			//Degrees, one unit of decodeCoordinate()
+
+typedef struct FIELD_T{
+	char text[16];	//ddmm.mmmm or dddmm.mmmm
+	char hemisphere;	//N/S/E/W
+	bool longitude;	//true for dddmm.mmmm
+	double exact;		//Signed decimal degrees
+}FIELD;
+
+/* ------------------------------------------------------------ */
+/*  Previous path, copied from PmodGPS.cpp and the tracking sketch
+*/
+static void legacyFormatCOORDS(char* coords)
+{
+	char formatted[14]={0};
+	int i=0;
+	char* coordsstart= coords;
+
+	while (*(coords)){
+		formatted[i]=*coords;
+		formatted[++i]; coords++;
+		if (*(coords+2)=='.')
+		{
+			formatted[i]=(char)0xB0;//degrees symbol
+			i++;
+		}
+		else if (*coords=='.')
+		{
+			formatted[i] = 39;// ' symbol for minutes
+			i++;
+			coords++;
+		}
+		else if (*(coords-3)=='.')
+		{
+			formatted[i]='.';//Decimal for seconds
+			i++;
+		}
+		else if (*(coords-5)=='.')
+		{
+			formatted[i]='"';// " for seconds
+			i++;
+			formatted[i]=0;//Null char
+		}
+	}
+	strcpy(coordsstart, formatted);
+}
+
+static float legacyLatitude(const std::string& lat)
+{
+	float degrees = atof(lat.substr(0,2).c_str());
+	degrees += atof(lat.substr(3,2).c_str()) / 60;
+	degrees += atof(lat.substr(6,5).c_str()) / 3600;
+	return degrees;
+}
+
+static float legacyLongitude(const std::string& longit)
+{
+	const float SeattleLatitude = 47.6062;
+	float degrees = atof(longit.substr(0,3).c_str());
+	degrees += atof(longit.substr(4,2).c_str()) / 60;
+	degrees += cos(SeattleLatitude*M_PI/180)*(atof(longit.substr(7,5).c_str()) / 3600);
+	return degrees;
+}
+
+static float legacyDecode(const FIELD& f)
+{
+	char buf[16];
+	float degrees;
+
+	strcpy(buf, f.text);
+	legacyFormatCOORDS(buf);
+	degrees = f.longitude ? legacyLongitude(buf) : legacyLatitude(buf);
+	return (f.hemisphere == 'S' || f.hemisphere == 'W') ? -degrees : degrees;//Sketch had no sign, given here
+}
+
+/* ------------------------------------------------------------ */
+/*  makeFields()
+**
+**  Description:
+**    Random fields with the four decimal places the PmodGPS prints.
+*/
+static std::vector<FIELD> makeFields(size_t count)
+{
+	std::vector<FIELD> fields(count);
+	size_t i;
+
+	srand(1);
+	for (i = 0; i < count; i++){
+		FIELD& f = fields[i];
+		long degrees, minutesE4;
+
+		f.longitude = i & 1;
+		degrees = rand() % (f.longitude ? 180 : 90);
+		minutesE4 = rand() % 600000;
+		snprintf(f.text, sizeof(f.text), f.longitude ? "%03ld%02ld.%04ld" : "%02ld%02ld.%04ld", degrees, minutesE4 / 10000, minutesE4 % 10000);
+		f.hemisphere = f.longitude ? ((rand() & 1) ? 'E' : 'W') : ((rand() & 1) ? 'N' : 'S');
+		f.exact = degrees + minutesE4 / 600000.0;
+		if (f.hemisphere == 'S' || f.hemisphere == 'W'){
+			f.exact = -f.exact;
+		}
+	}
+	return fields;
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+	std::vector<FIELD> fields = makeFields(count);
+	double legacyErr = 0, newErr = 0, sink = 0;
+	size_t i, failures = 0;
+
+	auto t0 = std::chrono::steady_clock::now();
+	for (i = 0; i < count; i++){
+		float degrees = legacyDecode(fields[i]);
+		sink += degrees;
+		legacyErr = fmax(legacyErr, fabs(degrees - fields[i].exact));
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	for (i = 0; i < count; i++){
+		int32_t degE7 = 0;
+		bool ok = decodeCoordinate(fields[i].text, strlen(fields[i].text), fields[i].hemisphere, &degE7);
+		double err = fabs(degE7 / 1e7 - fields[i].exact);
+
+		sink += degE7;
+		newErr = fmax(newErr, err);
+		if ((!ok || err > MAX_ERROR) && failures++ < 10){
+			printf("MISMATCH %s,%c: %ld, exact %.8f\n", fields[i].text, fields[i].hemisphere, (long)degE7, fields[i].exact);
+		}
+	}
+	auto t2 = std::chrono::steady_clock::now();
+
+	double legacyNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / count;
+	double newNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / count;
+
+	printf("coordinates:        %zu\n", count);
+	printf("formatCOORDS + DMS: %8.1f ns/coord  max error %10.3f m\n", legacyNs, legacyErr * METERS_PER_DEGREE);
+	printf("decodeCoordinate:   %8.1f ns/coord  max error %10.3f m\n", newNs, newErr * METERS_PER_DEGREE);
+	printf("speedup:            %8.1fx\n", legacyNs / newNs);
+	printf("over %.0e deg:     %8zu\n", MAX_ERROR, failures);
+	printf("%s\n", (failures || sink == 0.5) ? "FAILED" : "passed");//sink keeps the loops from being optimized out
+	return (failures || sink == 0.5) ? 1 : 0;
+}
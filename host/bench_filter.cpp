@@ -0,0 +1,232 @@
+/************************************************************************/
+/*																		*/
+/*	bench_filter.cpp  Host check and benchmark of GPSFilter				*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Drives GPSFilter with generated fixes whose true position is known	*/
+/*	and checks that:													*/
+/*	  both modes converge on a straight track of noisy positions and	*/
+/*	  VTG velocities, with a smaller position error than the fixes		*/
+/*	  and the right speed and course									*/
+/*	  a fix with a high HDOP moves the estimate less than the same fix	*/
+/*	  with a low one													*/
+/*	  after a gap longer than FILTER_TIMEOUT the filter starts over at	*/
+/*	  the new fix, and a long drive past FILTER_REANCHOR stays accurate	*/
+/*	Reports fixes per second for both modes. Exits with 1 if any check	*/
+/*	fails.																*/
+/*																		*/
+/*	Usage: bench_filter [fixes]											*/
+/*																		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "GPSFilter.h"
+
+#define ORIGIN_LAT	476062000	//Seattle
+#define ORIGIN_LON	-1223321000
+#define TRACK_SPEED	10.0f		//m/s along the track
+#define HEADING		60.0f		//degrees from true north
+#define NOISE		5.0f		//Position noise of the fixes at HDOP 1, metres
+#define VEL_NOISE	0.2f		//Velocity noise of the fixes at HDOP 1, m/s
+#define SETTLE		60			//Fixes left out of the error while the filter settles
+
+static int failures;
+
+static void check(bool ok, const char* what)
+{
+	printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok){
+		failures++;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  Distance in metres from the state to a point on the plane
+*/
+static float stateError(const GEO_REF* origin, const FILTER_STATE& state, float e, float n)
+{
+	float se, sn;
+
+	geoOffset(origin, state.LAT, state.LON, &se, &sn);
+	return hypotf(se - e, sn - n);
+}
+
+/* ------------------------------------------------------------ */
+/*  Runs a noisy straight track at 1 Hz through the filter, each
+**  fix a position and a VTG speed and course, and reports the RMS errors after SETTLE fixes: of the fixes, of the
+**  estimate, and of its speed and course.
+*/
+static void straightTrack(FILTER_MODE mode, size_t fixes, float* rawRms, float* filterRms, float* speedRms, float* courseRms, FILTER_STATE* last)
+{
+	std::mt19937 rng(11);
+	std::normal_distribution<float> noise(0, NOISE);
+	std::normal_distribution<float> velNoise(0, VEL_NOISE);
+	float sinH = sinf(HEADING * M_PI / 180), cosH = cosf(HEADING * M_PI / 180);
+	double raw = 0, filtered = 0, speed = 0, course = 0;
+	GPSFilter filter;
+	GEO_REF origin;
+	size_t i;
+
+	geoSetReference(&origin, ORIGIN_LAT, ORIGIN_LON);
+	filter.setMode(mode);
+	for (i = 0; i < fixes; i++){
+		float e = TRACK_SPEED * i * sinH, n = TRACK_SPEED * i * cosH;
+		float fe = e + noise(rng), fn = n + noise(rng);
+		float ve = TRACK_SPEED * sinH + velNoise(rng), vn = TRACK_SPEED * cosH + velNoise(rng);
+		int32_t lat, lon;
+
+		geoPosition(&origin, fe, fn, &lat, &lon);
+		filter.updatePosition(lat, lon, 5000, i * 1000, 100, 150);
+		filter.updateVelocity((uint32_t)(hypotf(ve, vn) * 1000), (uint16_t)(geoBearing(ve, vn) * 100), 100);
+		*last = filter.getState();
+		if (i >= SETTLE){
+			float err = stateError(&origin, *last, e, n);
+			float dv = last->SPEED / 1000.0f - TRACK_SPEED;
+			float dc = last->COURSE / 100.0f - HEADING;
+
+			raw += (fe - e) * (fe - e) + (fn - n) * (fn - n);
+			filtered += err * err;
+			speed += dv * dv;
+			course += dc * dc;
+		}
+	}
+	*rawRms = sqrt(raw / (fixes - SETTLE));
+	*filterRms = sqrt(filtered / (fixes - SETTLE));
+	*speedRms = sqrt(speed / (fixes - SETTLE));
+	*courseRms = sqrt(course / (fixes - SETTLE));
+}
+
+/* ------------------------------------------------------------ */
+/*  Settles a filter on a still point, then gives it one fix 50 m
+**  east with the given HDOP and returns how far the estimate moved.
+*/
+static float outlierShift(FILTER_MODE mode, uint16_t hdop)
+{
+	GPSFilter filter;
+	GEO_REF origin;
+	FILTER_STATE state;
+	int32_t lat, lon;
+	uint32_t i;
+
+	geoSetReference(&origin, ORIGIN_LAT, ORIGIN_LON);
+	filter.setMode(mode);
+	for (i = 0; i < 30; i++){
+		filter.updatePosition(ORIGIN_LAT, ORIGIN_LON, 5000, i * 1000, 100, 150);
+	}
+	geoPosition(&origin, 50, 0, &lat, &lon);
+	filter.updatePosition(lat, lon, 5000, i * 1000, hdop, 150);
+	state = filter.getState();
+	return stateError(&origin, state, 0, 0);
+}
+
+/* ------------------------------------------------------------ */
+/*  Fixes per second through updatePosition() and getState()
+*/
+static double fixRate(FILTER_MODE mode, size_t fixes)
+{
+	std::mt19937 rng(3);
+	std::normal_distribution<float> noise(0, 1e-5f);
+	std::vector<int32_t> lat(fixes), lon(fixes);
+	GPSFilter filter;
+	volatile int32_t sink = 0;
+	size_t i;
+
+	for (i = 0; i < fixes; i++){
+		lat[i] = ORIGIN_LAT + (int32_t)(i * 50) + (int32_t)(noise(rng) * 1e7f);
+		lon[i] = ORIGIN_LON + (int32_t)(i * 90) + (int32_t)(noise(rng) * 1e7f);
+	}
+	filter.setMode(mode);
+	auto t0 = std::chrono::steady_clock::now();
+	for (i = 0; i < fixes; i++){
+		filter.updatePosition(lat[i], lon[i], 5000, (i * 1000) % 86400000, 100, 150);
+		filter.updateVelocity(10000, 6000, 100);
+		sink += filter.getState().LAT;
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	(void)sink;
+	return fixes / std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char** argv)
+{
+	size_t fixes = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+	float raw, filtered, speed, course, shiftLow, shiftHigh;
+	FILTER_STATE state;
+	char what[80];
+
+	printf("Kalman, noisy straight track (%.0f m and %.1f m/s noise, %.0f m/s):\n", NOISE, VEL_NOISE, TRACK_SPEED);
+	straightTrack(FILTER_KALMAN, 600, &raw, &filtered, &speed, &course, &state);
+	snprintf(what, sizeof(what), "RMS error %.2f m, fixes %.2f m", filtered, raw);
+	check(filtered < raw * 0.4f, what);
+	snprintf(what, sizeof(what), "RMS error %.2f m/s, %.2f degrees", speed, course);
+	check(speed < 0.4f && course < 2.5f, what);
+	snprintf(what, sizeof(what), "estimated error %.2f m", state.HACC / 100.0);
+	check(state.HACC > filtered * 50 && state.HACC < filtered * 200, what);
+
+	printf("Alpha-beta, the same track:\n");
+	straightTrack(FILTER_ALPHA_BETA, 600, &raw, &filtered, &speed, &course, &state);
+	snprintf(what, sizeof(what), "RMS error %.2f m, fixes %.2f m", filtered, raw);
+	check(filtered < raw * 0.7f, what);
+	snprintf(what, sizeof(what), "RMS error %.2f m/s, %.2f degrees", speed, course);
+	check(speed < 1 && course < 5, what);
+	check(state.HACC == 0, "no estimated error");
+
+	printf("HDOP weighting, one fix 50 m off:\n");
+	shiftLow = outlierShift(FILTER_KALMAN, 100);
+	shiftHigh = outlierShift(FILTER_KALMAN, 500);
+	snprintf(what, sizeof(what), "Kalman moved %.2f m at HDOP 1, %.2f m at HDOP 5", shiftLow, shiftHigh);
+	check(shiftHigh < shiftLow / 2, what);
+	shiftLow = outlierShift(FILTER_ALPHA_BETA, 100);
+	shiftHigh = outlierShift(FILTER_ALPHA_BETA, 500);
+	snprintf(what, sizeof(what), "alpha-beta moved %.2f m at HDOP 1, %.2f m at HDOP 5", shiftLow, shiftHigh);
+	check(shiftHigh < shiftLow / 2, what);
+
+	printf("Gaps and re-anchoring:\n");
+	{
+		GPSFilter filter;
+		GEO_REF origin, far;
+		int32_t lat, lon;
+		uint32_t i;
+		float err, worst = 0;
+
+		geoSetReference(&origin, ORIGIN_LAT, ORIGIN_LON);
+		filter.setMode(FILTER_KALMAN);
+		for (i = 0; i < 30; i++){
+			geoPosition(&origin, TRACK_SPEED * i, 0, &lat, &lon);
+			filter.updatePosition(lat, lon, 5000, i * 1000, 100, 150);
+		}
+		//50 km north after a gap longer than FILTER_TIMEOUT
+		geoPosition(&origin, 0, 50000, &lat, &lon);
+		filter.updatePosition(lat, lon, 7000, (i + 20) * 1000, 100, 150);
+		state = filter.getState();
+		snprintf(what, sizeof(what), "after a 20 s gap: %d, %d at %d cm, %u mm/s", (int)(state.LAT - lat), (int)(state.LON - lon), (int)state.ALT, state.SPEED);
+		check(state.LAT == lat && state.LON == lon && state.ALT == 7000 && state.SPEED == 0, what);
+
+		//30 km east, noise free, across several moves of the origin
+		filter.reset();
+		geoSetReference(&far, ORIGIN_LAT, ORIGIN_LON);
+		for (i = 0; i < 1000; i++){
+			geoPosition(&far, 30.0f * i, 0, &lat, &lon);
+			filter.updatePosition(lat, lon, 5000, i * 1000, 100, 150);
+			if (i >= SETTLE){
+				err = stateError(&far, filter.getState(), 30.0f * i, 0);
+				worst = err > worst ? err : worst;
+			}
+		}
+		snprintf(what, sizeof(what), "30 km drive, worst error %.2f m", worst);
+		check(worst < 1, what);
+	}
+
+	printf("GPSFilter:        %10.0f fixes/s Kalman\n", fixRate(FILTER_KALMAN, fixes));
+	printf("                  %10.0f fixes/s alpha-beta\n", fixRate(FILTER_ALPHA_BETA, fixes));
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+/************************************************************************/
+/*																		*/
+/*	bench_geofence.cpp  Host benchmark of the geofence engine			*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Builds a set of random circle and concave polygon fences over a		*/
+/*	20 km square and drives a noisy track through it. Each fix goes		*/
+/*	through GPSGeofence::update() and through a plain loop that does	*/
+/*	the full test of every fence with the same hysteresis rules. Their	*/
+/*	fence states must agree after every fix. Reports fixes per second	*/
+/*	for both, and how many fences per fix needed the full test. Exits	*/
+/*	with 1 if the states ever differ.									*/
+/*																		*/
+/*	Usage: bench_geofence [fences] [fixes]								*/
+/*																		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "GPSGeofence.h"
+
+#define ORIGIN_LAT	476062000	//Seattle
+#define ORIGIN_LON	-1223321000
+#define AREA		20000.0		//Side of the fenced square, metres
+#define MAX_VERTICES 12
+
+static uint32_t events;
+
+static void countEvent(uint16_t fence, FENCE_EVENT event)
+{
+	(void)fence;
+	(void)event;
+	events++;
+}
+
+/* ------------------------------------------------------------ */
+/*  Full test of every fence, written out plainly
+*/
+static float plainDistance(const GEOFENCE& f, GEO_POINT p)
+{
+	if (f.TYPE == FENCE_CIRCLE){
+		return f.RADIUS - hypotf(p.E - f.CENTER.E, p.N - f.CENTER.N);
+	}
+	bool inside = false;
+	float best = INFINITY;
+	for (uint16_t i = 0, j = f.COUNT - 1; i < f.COUNT; j = i++){
+		GEO_POINT a = f.POINTS[j], b = f.POINTS[i];
+		if ((a.N > p.N) != (b.N > p.N) && p.E - a.E < (b.E - a.E) * (p.N - a.N) / (b.N - a.N)){
+			inside = !inside;
+		}
+		float eE = b.E - a.E, eN = b.N - a.N;
+		float t = ((p.E - a.E) * eE + (p.N - a.N) * eN) / (eE * eE + eN * eN);
+		t = fminf(1, fmaxf(0, t));
+		best = fminf(best, hypotf(p.E - a.E - t * eE, p.N - a.N - t * eN));
+	}
+	return inside ? best : -best;
+}
+
+static void plainUpdate(const std::vector<GEOFENCE>& fences, std::vector<uint8_t>& states, GEO_POINT p, float hysteresis)
+{
+	for (size_t i = 0; i < fences.size(); i++){
+		float d = plainDistance(fences[i], p);
+		if (states[i] == FENCE_UNKNOWN){
+			states[i] = d >= 0 ? FENCE_INSIDE : FENCE_OUTSIDE;
+		}
+		else if (states[i] == FENCE_INSIDE && d < -hysteresis){
+			states[i] = FENCE_OUTSIDE;
+		}
+		else if (states[i] == FENCE_OUTSIDE && d > hysteresis){
+			states[i] = FENCE_INSIDE;
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t numFences = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000;
+	size_t numFixes = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> unit(0, 1);
+	std::normal_distribution<float> noise(0, 5);
+	std::vector<GEOFENCE> fences(numFences), copy;
+	std::vector<GEO_POINT> points(numFences * MAX_VERTICES);
+	std::vector<WAYPOINT> vertices(MAX_VERTICES);
+	std::vector<int32_t> fixLat(numFixes), fixLon(numFixes);
+	std::vector<GEO_POINT> fixPlane(numFixes);
+	std::vector<uint8_t> states(numFences, FENCE_UNKNOWN);
+	GPSGeofence engine;
+	GEO_REF origin;
+	size_t i, j, mismatches = 0;
+
+	geoSetReference(&origin, ORIGIN_LAT, ORIGIN_LON);
+	engine.begin(fences.data(), numFences, ORIGIN_LAT, ORIGIN_LON);
+	engine.setCallback(countEvent);
+	for (i = 0; i < numFences; i++){
+		float cE = (unit(rng) - 0.5f) * AREA, cN = (unit(rng) - 0.5f) * AREA;
+		float radius = 50 + unit(rng) * 450;
+		int32_t lat, lon;
+
+		if (i & 1){
+			geoPosition(&origin, cE, cN, &lat, &lon);
+			engine.addCircle(lat, lon, radius);
+			continue;
+		}
+		uint16_t n = 5 + rng() % (MAX_VERTICES - 4);
+		for (j = 0; j < n; j++){//A star, every other vertex pulled in, so concave
+			float angle = 2 * M_PI * j / n;
+			float r = radius * ((j & 1) ? 0.4f + 0.3f * unit(rng) : 0.8f + 0.2f * unit(rng));
+			geoPosition(&origin, cE + r * sinf(angle), cN + r * cosf(angle), &vertices[j].LAT, &vertices[j].LON);
+		}
+		engine.addPolygon(waypointReadRam, vertices.data(), n, &points[i * MAX_VERTICES]);
+	}
+
+	//A walk at about 15 m/s that turns now and then, with 5 m of noise
+	float e = 0, n = 0, heading = 0;
+	for (i = 0; i < numFixes; i++){
+		heading += (unit(rng) - 0.5f) * 0.3f;
+		e += 15 * sinf(heading);
+		n += 15 * cosf(heading);
+		if (fabsf(e) > AREA / 2 || fabsf(n) > AREA / 2){
+			heading += M_PI;
+		}
+		geoPosition(&origin, e + noise(rng), n + noise(rng), &fixLat[i], &fixLon[i]);
+		geoOffset(&origin, fixLat[i], fixLon[i], &fixPlane[i].E, &fixPlane[i].N);
+	}
+
+	copy = fences;	//As added, before any fix, for the plain loop
+	auto t0 = std::chrono::steady_clock::now();
+	for (i = 0; i < numFixes; i++){
+		plainUpdate(copy, states, fixPlane[i], FENCE_HYSTERESIS);
+	}
+	auto t1 = std::chrono::steady_clock::now();
+	std::vector<uint8_t> plainStates = states;
+
+	std::fill(states.begin(), states.end(), (uint8_t)FENCE_UNKNOWN);
+	double engineSeconds = 0;
+	for (i = 0; i < numFixes; i++){
+		auto a = std::chrono::steady_clock::now();
+		engine.update(fixLat[i], fixLon[i], i * 1000);
+		engineSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - a).count();
+
+		plainUpdate(copy, states, fixPlane[i], FENCE_HYSTERESIS);	//Untimed, to compare every fix
+		for (j = 0; j < numFences; j++){
+			if (engine.getState(j) != states[j] && mismatches++ < 10){
+				printf("MISMATCH fix %zu fence %zu: engine %d plain %d\n", i, j, engine.getState(j), states[j]);
+			}
+		}
+	}
+
+	double plainSeconds = std::chrono::duration<double>(t1 - t0).count();
+	printf("fences:            %zu (half circles, half polygons of 5-%d vertices)\n", numFences, MAX_VERTICES);
+	printf("fixes:             %zu\n", numFixes);
+	printf("events:            %u\n", events);
+	printf("full test:         %10.0f fixes/s\n", numFixes / plainSeconds);
+	printf("GPSGeofence:       %10.0f fixes/s  %.1f full tests per fix\n", numFixes / engineSeconds, (double)engine.getFullTests() / numFixes);
+	printf("speedup:           %10.1fx\n", plainSeconds / engineSeconds);
+	printf("%s\n", mismatches ? "FAILED" : "passed");
+	return mismatches ? 1 : 0;
+}
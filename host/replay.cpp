@@ -0,0 +1,248 @@
+/************************************************************************/
+/*																		*/
+/*	replay.cpp  Host replay harness for the PmodGPS library				*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Feeds a recorded NMEA log, or generated traffic, through the real	*/
+/*	GPS class via GPS::getData() on a stand-in HardwareSerial port and	*/
+/*	reports throughput and per sentence type parse latency. Use it to	*/
+/*	get a repeatable baseline before and after a parser change.			*/
+/*	Also checks that the sentences add up to complete epochs, and		*/
+/*	exits with 1 if none do.											*/
+/*																		*/
+/*	Usage: replay [-b baud] [-n epochs] [-r runs] [-g] [-l log] [file]	*/
+/*	  -b baud	pace the bytes at the given baud rate (8N1) instead of	*/
+/*				replaying as fast as possible							*/
+/*	  -n epochs	number of generated epochs when no file is given		*/
+/*	  -r runs	replay the data this many times							*/
+/*	  -g		write the generated traffic to stdout and exit			*/
+/*	  -l log	write every GGA with a fix to a GPSTrackLog file, which	*/
+/*				trackdump turns back into NMEA or CSV					*/
+/*																		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "PmodGPS.h"
+#include "GPSTrackLog.h"
+
+static const char* const typeName[NMEA_TYPES] = {"other", "GGA", "GSA", "GSV", "RMC", "VTG", "GLL", "ZDA", "TXT", "PMTK001"};
+
+/* ------------------------------------------------------------ */
+/*  addSentence()
+**
+**  Description:
+**    Appends "$body*hh<CR><LF>" with the checksum of body.
+*/
+static void addSentence(std::string& out, const char* body)
+{
+	uint8_t checksum = 0;
+	char tail[8];
+	const char* p;
+
+	for (p = body; *p; p++){
+		checksum ^= (uint8_t)*p;
+	}
+	snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+	out += '$';
+	out += body;
+	out += tail;
+}
+
+/* ------------------------------------------------------------ */
+/*  generate()
+**
+**  Description:
+**    One second epochs of the sentences the PmodGPS sends by
+**	  default (GGA, GSA, three GSV, RMC, VTG) for a receiver driving
+**	  a slow circle around Seattle.
+*/
+static std::string generate(unsigned epochs)
+{
+	std::string out;
+	char body[MAX_SIZE];
+	unsigned i, k;
+
+	for (i = 0; i < epochs; i++){
+		unsigned t = 6 * 3600 + i;//Seconds since midnight
+		double angle = i * 0.01;
+		double lat = 47.6062 + 0.01 * sin(angle);
+		double lon = -122.3321 + 0.015 * cos(angle);
+		double latMin = (fabs(lat) - (int)fabs(lat)) * 60;
+		double lonMin = (fabs(lon) - (int)fabs(lon)) * 60;
+		char utc[32], latStr[32], lonStr[32];
+
+		snprintf(utc, sizeof(utc), "%02u%02u%02u.000", t / 3600 % 24, t / 60 % 60, t % 60);
+		snprintf(latStr, sizeof(latStr), "%02d%07.4f,%c", (int)fabs(lat), latMin, lat < 0 ? 'S' : 'N');
+		snprintf(lonStr, sizeof(lonStr), "%03d%07.4f,%c", (int)fabs(lon), lonMin, lon < 0 ? 'W' : 'E');
+
+		snprintf(body, sizeof(body), "GPGGA,%s,%s,%s,1,%u,0.%02u,%.1f,M,-17.3,M,,", utc, latStr, lonStr, 8 + i % 4, 80 + i % 20, 45.0 + (i % 50) * 0.1);
+		addSentence(out, body);
+		addSentence(out, "GPGSA,A,3,29,21,26,15,18,09,06,10,,,,,1.32,0.95,0.91");
+		for (k = 1; k <= 3; k++){
+			snprintf(body, sizeof(body), "GPGSV,3,%u,12,%02u,%02u,%03u,%02u,%02u,%02u,%03u,%02u,%02u,%02u,%03u,%02u,%02u,%02u,%03u,%02u", k,
+				k * 4, 10 + k, 30 * k, 35 + k, k * 4 + 1, 20 + k, 40 * k, 30 + k, k * 4 + 2, 30 + k, 50 * k, 40 - k, k * 4 + 3, 40 + k, 60 * k, 25 + k);
+			addSentence(out, body);
+		}
+		snprintf(body, sizeof(body), "GPRMC,%s,A,%s,%s,%.2f,%.2f,160418,,,A", utc, latStr, lonStr, 10.0 + i % 7, fmod(angle * 57.3 + 90, 360));
+		addSentence(out, body);
+		snprintf(body, sizeof(body), "GPVTG,%.2f,T,,M,%.2f,N,%.2f,K,A", fmod(angle * 57.3 + 90, 360), 10.0 + i % 7, (10.0 + i % 7) * 1.852);
+		addSentence(out, body);
+	}
+	return out;
+}
+
+static std::string readFile(const char* name)
+{
+	std::string data;
+	char buf[4096];
+	size_t n;
+	FILE* f = fopen(name, "rb");
+
+	if (f == NULL){
+		perror(name);
+		exit(1);
+	}
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0){
+		data.append(buf, n);
+	}
+	fclose(f);
+	return data;
+}
+
+static bool writeLogBlock(void* context, const uint8_t* block, uint16_t size)
+{
+	return fwrite(block, 1, size, (FILE*)context) == size;
+}
+
+static double percentile(std::vector<double>& v, double p)
+{
+	size_t i;
+
+	if (v.empty()){
+		return 0;
+	}
+	i = (size_t)(p * (v.size() - 1) + 0.5);
+	std::nth_element(v.begin(), v.begin() + i, v.end());
+	return v[i];
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long baud = UART_NO_PACING;
+	unsigned epochs = 10000;
+	unsigned runs = 1;
+	bool dump = false;
+	const char* logName = NULL;
+	FILE* logFile = NULL;
+	GPSTrackLog trackLog;
+	std::vector<double> latency[NMEA_TYPES];
+	std::string data;
+	GPS gps;
+	int opt;
+	unsigned run;
+	unsigned t;
+
+	while ((opt = getopt(argc, argv, "b:n:r:gl:")) != -1){
+		switch(opt){
+			case 'b':baud = strtoul(optarg, NULL, 10);
+				break;
+			case 'n':epochs = strtoul(optarg, NULL, 10);
+				break;
+			case 'r':runs = strtoul(optarg, NULL, 10);
+				break;
+			case 'g':dump = true;
+				break;
+			case 'l':logName = optarg;
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-b baud] [-n epochs] [-r runs] [-g] [-l log] [file]\n", argv[0]);
+				return 1;
+		}
+	}
+	data = optind < argc ? readFile(argv[optind]) : generate(epochs);
+	if (dump){
+		fwrite(data.data(), 1, data.size(), stdout);
+		return 0;
+	}
+
+	if (logName){
+		logFile = fopen(logName, "wb");
+		if (logFile == NULL){
+			perror(logName);
+			return 1;
+		}
+		trackLog.begin(writeLogBlock, logFile);
+	}
+
+	gps.GPSinit(Serial, baud ? baud : 9600, 6, 7);
+	auto start = std::chrono::steady_clock::now();
+	for (run = 0; run < runs; run++){
+		unsigned idle = 0;
+
+		hostUartLoad(0, (const uint8_t*)data.data(), data.size(), baud);
+		while (hostUartRemaining(0) || idle < 2){
+			auto t0 = std::chrono::steady_clock::now();
+			NMEA mode = gps.getData(Serial);
+			auto t1 = std::chrono::steady_clock::now();
+
+			if (mode == INVALID){
+				idle = hostUartRemaining(0) ? 0 : idle + 1;
+				continue;
+			}
+			idle = 0;
+			latency[mode].push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+			if (logFile && mode == GGA && gps.isFixed()){
+				FIX fix = gps.getFix();
+				TRACK_POINT point = {fix.LAT, fix.LON, fix.UTC, fix.ALT, fix.SPEED};
+				trackLog.append(&point);
+			}
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	size_t sentences = 0;
+	for (t = 0; t < NMEA_TYPES; t++){
+		sentences += latency[t].size();
+	}
+	RING_STATS rx = gps.getRxStats();
+	NMEA_STATS gga = gps.getStats(GGA);
+	NMEA_STATS rmc = gps.getStats(RMC);
+	unsigned expected = optind < argc ? (gga.accepted || rmc.accepted) : epochs;	//At least this many
+	bool epochsOk = gps.getEpochSequence() >= expected;
+
+	printf("bytes:      %zu x %u run(s)%s\n", data.size(), runs, baud ? "" : ", unpaced");
+	printf("sentences:  %zu in %.3f s\n", sentences, seconds);
+	printf("throughput: %.0f sentences/s, %.0f bytes/s\n", sentences / seconds, data.size() * (double)runs / seconds);
+	printf("rx ring:    high water %u of %u, %u dropped\n", rx.highWater, GPS_RX_BUFFER_SIZE - 1, rx.dropped);
+	printf("epochs:     %u complete, %s\n", gps.getEpochSequence(), epochsOk ? "passed" : "FAILED");
+	if (logFile){
+		trackLog.flush();
+		fclose(logFile);
+		printf("track log:  %u points in %u blocks of %u bytes, %.1f bytes/point\n", trackLog.getPoints(), trackLog.getBlocks(),
+			TRACK_BLOCK_SIZE, trackLog.getPoints() ? (double)trackLog.getBlocks() * TRACK_BLOCK_SIZE / trackLog.getPoints() : 0.0);
+	}
+	printf("\n");
+	printf("%-8s %9s %9s %9s %9s %9s %9s %9s %9s\n", "type", "parsed", "accepted", "rejected", "truncated", "p50 ns", "p90 ns", "p99 ns", "max ns");
+	for (t = 0; t < NMEA_TYPES; t++){
+		NMEA_STATS st = gps.getStats((NMEA)t);
+		std::vector<double>& v = latency[t];
+
+		if (v.empty() && st.accepted == 0 && st.rejected == 0 && st.truncated == 0){
+			continue;
+		}
+		printf("%-8s %9zu %9u %9u %9u %9.0f %9.0f %9.0f %9.0f\n", typeName[t], v.size(), st.accepted, st.rejected, st.truncated,
+			percentile(v, 0.5), percentile(v, 0.9), percentile(v, 0.99), v.empty() ? 0.0 : *std::max_element(v.begin(), v.end()));
+	}
+	return epochsOk ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+#!/bin/sh
+# Code and RAM sizes of PmodGPS.cpp built with a few PmodGPSConfig.h settings.
+# Usage: ./size_report.sh
+# The host compiler is used by default. Its sizes are for the host's
+# instruction set and pointer size, not the Uno's: they only compare the
+# configurations with each other and are labelled as host sizes. For the
+# footprint on the Uno point it at the Arduino toolchain, e.g.
+#   CXX=avr-g++ SIZE=avr-size CXXFLAGS="-mmcu=atmega328p -DF_CPU=16000000L -I<core> -I<variant>" ./size_report.sh
+
+LIB=../PmodGPS_GPS_Tracking_to_Reference
+CXX=${CXX:-g++}
+SIZE=${SIZE:-size}
+CXXFLAGS=${CXXFLAGS:--Istubs}
+TMP=${TMPDIR:-/tmp}/size_report.$$
+
+TARGET=`$CXX -dumpmachine 2>/dev/null`
+NOCFG=-DGPS_NO_USER_CONFIG
+ALL="$NOCFG -DGPS_USE_GLL=1 -DGPS_USE_ZDA=1 -DGPS_USE_TXT=1"
+GGA_ONLY="$NOCFG -DGPS_USE_GSA=0 -DGPS_USE_GSV=0 -DGPS_USE_RMC=0 -DGPS_USE_VTG=0 -DGPS_USE_ACK=0 -DGPS_USE_FILTER=0 -DGPS_USE_PPS=0 -DGPS_USE_DF=0"
+
+mkdir -p $TMP || exit 1
+trap 'rm -rf $TMP' EXIT
+echo 'GPS gpsInstance;' > $TMP/instance.cpp
+
+case $TARGET in
+avr*)	echo "AVR sizes ($TARGET)";;
+*)	echo "HOST SIZES ($TARGET): for comparing configurations only, not the AVR footprint";;
+esac
+printf '%-28s %8s %8s %8s\n' configuration text data 'sizeof(GPS)'
+report()
+{
+	name=$1
+	shift
+	$CXX -std=c++11 -Os -ffunction-sections -fdata-sections $CXXFLAGS -I$LIB "$@" -c $LIB/PmodGPS.cpp -o $TMP/gps.o || exit 1
+	$CXX -std=c++11 -Os $CXXFLAGS -I$LIB "$@" -include PmodGPS.h -c $TMP/instance.cpp -o $TMP/instance.o || exit 1
+	$SIZE $TMP/gps.o | awk -v name="$name" 'NR == 2 {text = $1; data = $2}
+		END {printf "%-28s %8d %8d ", name, text, data}'
+	$SIZE $TMP/instance.o | awk 'NR == 2 {printf "%8d\n", $2 + $3}'
+}
+
+report "everything"               $ALL -DGPS_USE_STRINGS=1
+report "everything, no strings"   $ALL -DGPS_USE_STRINGS=0
+report "PmodGPSConfig.h defaults" $NOCFG
+report "PmodGPSUserConfig.h"
+report "GGA only"                 $GGA_ONLY
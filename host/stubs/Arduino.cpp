@@ -0,0 +1,101 @@
+/************************************************************************/
+/*																		*/
+/*	Arduino.cpp  Host stand-in for the Arduino core						*/
+/*																		*/
+/************************************************************************/
+
+#include "Arduino.h"
+
+#include <chrono>
+#include <thread>
+
+#define HOST_PINS  64
+
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+static int pinValue[HOST_PINS];
+static void (*pinISR[HOST_PINS])(void);
+static int pinISRMode[HOST_PINS];
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+	if (pin < HOST_PINS && mode == INPUT_PULLUP){
+		pinValue[pin] = HIGH;
+	}
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+	if (pin < HOST_PINS){
+		pinValue[pin] = value;
+	}
+}
+
+int digitalRead(uint8_t pin)
+{
+	return pin < HOST_PINS ? pinValue[pin] : LOW;
+}
+
+unsigned long millis(void)
+{
+	return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long micros(void)
+{
+	//Wraps at 2^32 like the Arduino counter
+	return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(unsigned long ms)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+	std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(void)
+{
+	std::this_thread::yield();
+}
+
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode)
+{
+	if (interrupt < HOST_PINS){
+		pinISR[interrupt] = isr;
+		pinISRMode[interrupt] = mode;
+	}
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+	if (interrupt < HOST_PINS){
+		pinISR[interrupt] = NULL;
+	}
+}
+
+/* ------------------------------------------------------------ */
+/*  hostSetPin()
+**
+**  Description:
+**    Changes an input pin and runs its attached interrupt handler
+**	  if the change matches the handler's mode.
+*/
+void hostSetPin(uint8_t pin, int value)
+{
+	int old;
+
+	if (pin >= HOST_PINS){
+		return;
+	}
+	old = pinValue[pin];
+	pinValue[pin] = value;
+	if (pinISR[pin] == NULL || old == value){
+		return;
+	}
+	if (pinISRMode[pin] == CHANGE || (pinISRMode[pin] == RISING && value == HIGH) || (pinISRMode[pin] == FALLING && value == LOW)){
+		pinISR[pin]();
+	}
+}
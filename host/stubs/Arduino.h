@@ -0,0 +1,71 @@
+/************************************************************************/
+/*																		*/
+/*	Arduino.h  Host stand-in for the Arduino core						*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Just enough of the Arduino API for the PmodGPS library to build and	*/
+/*	run on a desktop computer. Time comes from the host's monotonic		*/
+/*	clock, pins do nothing and PROGMEM is ordinary memory.				*/
+/*																		*/
+/************************************************************************/
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define INPUT		0
+#define OUTPUT		1
+#define INPUT_PULLUP	2
+#define LOW			0
+#define HIGH		1
+#define CHANGE		1
+#define FALLING		2
+#define RISING		3
+
+#define NOT_AN_INTERRUPT	-1
+#define digitalPinToInterrupt(p)	((int)(p))
+
+#define PROGMEM
+#define PSTR(s)					(s)
+#define pgm_read_byte(addr)		(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)		(*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)	(*(const uint32_t*)(addr))
+#define pgm_read_ptr(addr)		(*(void* const*)(addr))
+#define memcpy_P				memcpy
+#define strlen_P				strlen
+
+#ifndef PI
+#define PI			3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD	0.017453292519943295769236907684886
+#define RAD_TO_DEG	57.295779513082320876798154814105
+
+#define noInterrupts()
+#define interrupts()
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield(void);
+void attachInterrupt(uint8_t interrupt, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+//Host only: drive a pin as if an external device changed it
+void hostSetPin(uint8_t pin, int value);
+
+#endif //Arduino_h
@@ -0,0 +1,43 @@
+/************************************************************************/
+/*																		*/
+/*	Stream.h  Host stand-in for the Arduino Print and Stream classes		*/
+/*																		*/
+/************************************************************************/
+
+#ifndef Stream_h
+#define Stream_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class Print
+{
+	public:
+	virtual ~Print() {}
+	virtual size_t write(uint8_t c) = 0;
+	virtual size_t write(const uint8_t* buffer, size_t size)
+	{
+		size_t n = 0;
+
+		while (n < size && write(buffer[n])){
+			n++;
+		}
+		return n;
+	}
+	virtual void flush() {}
+	size_t print(const char* str)
+	{
+		return write((const uint8_t*)str, strlen(str));
+	}
+};
+
+class Stream: public Print
+{
+	public:
+	virtual int available() = 0;
+	virtual int read() = 0;
+	virtual int peek() = 0;
+};
+
+#endif //Stream_h
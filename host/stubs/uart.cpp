@@ -0,0 +1,185 @@
+/************************************************************************/
+/*																		*/
+/*	uart.cpp  Host replay uart behind HardwareSerial					*/
+/*																		*/
+/************************************************************************/
+
+#include "Arduino.h"
+#include "HardwareSerial.h"
+
+#include <vector>
+
+#define HOST_UARTS  2
+
+struct uart_{
+	std::vector<uint8_t> rx;		//Bytes to replay
+	size_t rxPos;						//Next byte read
+	unsigned long wireBaud;		//Rate the bytes arrive at, UART_NO_PACING for all at once
+	unsigned long rxStart;		//micros() when replay started
+	unsigned long baud;			//Rate set by begin()
+	std::vector<uint8_t> tx;		//Bytes written
+};
+
+static uart_t uarts[HOST_UARTS];
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+
+uart_t* hostUart(int uart_nr)
+{
+	return (uart_nr >= 0 && uart_nr < HOST_UARTS) ? &uarts[uart_nr] : NULL;
+}
+
+/* ------------------------------------------------------------ */
+/*  hostUartLoad()
+**
+**  Description:
+**    Queues data to be received on a port. With a wireBaud, bytes
+**	  become available at wireBaud / 10 per second from now, as on
+**	  an 8N1 line, otherwise they are all available at once.
+*/
+void hostUartLoad(int uart_nr, const uint8_t* data, size_t len, unsigned long wireBaud)
+{
+	uart_t* uart = hostUart(uart_nr);
+
+	uart->rx.assign(data, data + len);
+	uart->rxPos = 0;
+	uart->wireBaud = wireBaud;
+	uart->rxStart = micros();
+}
+
+size_t hostUartRemaining(int uart_nr)
+{
+	uart_t* uart = hostUart(uart_nr);
+
+	return uart->rx.size() - uart->rxPos;
+}
+
+size_t hostUartWritten(int uart_nr, const uint8_t** data)
+{
+	uart_t* uart = hostUart(uart_nr);
+
+	*data = uart->tx.data();
+	return uart->tx.size();
+}
+
+void hostUartClearWritten(int uart_nr)
+{
+	hostUart(uart_nr)->tx.clear();
+}
+
+size_t uart_rx_available(uart_t* uart)
+{
+	size_t arrived;
+
+	if (uart == NULL){
+		return 0;
+	}
+	arrived = uart->rx.size();
+	if (uart->wireBaud != UART_NO_PACING){
+		arrived = (size_t)((uint64_t)(uint32_t)(micros() - uart->rxStart) * uart->wireBaud / 10000000UL);
+		if (arrived > uart->rx.size()){
+			arrived = uart->rx.size();
+		}
+	}
+	return arrived > uart->rxPos ? arrived - uart->rxPos : 0;
+}
+
+int uart_peek_char(uart_t* uart)
+{
+	return uart_rx_available(uart) ? uart->rx[uart->rxPos] : -1;
+}
+
+int uart_read_char(uart_t* uart)
+{
+	return uart_rx_available(uart) ? uart->rx[uart->rxPos++] : -1;
+}
+
+size_t uart_tx_free(uart_t* uart)
+{
+	return uart ? 128 : 0;
+}
+
+size_t uart_write_char(uart_t* uart, char c)
+{
+	if (uart == NULL){
+		return 0;
+	}
+	uart->tx.push_back((uint8_t)c);
+	return 1;
+}
+
+size_t uart_write(uart_t* uart, const char* buf, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++){
+		uart_write_char(uart, buf[i]);
+	}
+	return size;
+}
+
+void uart_swap(uart_t*, int) {}
+void uart_set_tx(uart_t*, int) {}
+void uart_set_pins(uart_t*, int, int) {}
+bool uart_tx_enabled(uart_t* uart) { return uart != NULL; }
+bool uart_rx_enabled(uart_t* uart) { return uart != NULL; }
+int uart_get_baudrate(uart_t* uart) { return uart ? (int)uart->baud : 0; }
+bool uart_has_overrun(uart_t*) { return false; }
+
+/* ------------------------------------------------------------ */
+/*  HardwareSerial
+**
+**  Description:
+**    The non-inline members of the library's HardwareSerial.h.
+*/
+HardwareSerial::HardwareSerial(int uart_nr)
+	: _uart_nr(uart_nr), _rx_size(256)
+{
+}
+
+void HardwareSerial::begin(unsigned long baud, SerialConfig, SerialMode, uint8_t)
+{
+	_uart = hostUart(_uart_nr);
+	if (_uart){
+		_uart->baud = baud;
+	}
+}
+
+void HardwareSerial::end()
+{
+	_uart = NULL;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size)
+{
+	_rx_size = size;
+	return size;
+}
+
+int HardwareSerial::available(void)
+{
+	return (int)uart_rx_available(_uart);
+}
+
+void HardwareSerial::flush(void)
+{
+}
+
+void HardwareSerial::setDebugOutput(bool)
+{
+}
+
+void HardwareSerial::startDetectBaudrate()
+{
+}
+
+unsigned long HardwareSerial::testBaudrate()
+{
+	return _uart ? _uart->wireBaud : 0;
+}
+
+unsigned long HardwareSerial::detectBaudrate(time_t)
+{
+	return testBaudrate();
+}
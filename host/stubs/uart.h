@@ -0,0 +1,57 @@
+/************************************************************************/
+/*																		*/
+/*	uart.h  Host stand-in for the ESP8266 uart driver					*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Backs the HardwareSerial.h in the library folder. Each port replays	*/
+/*	a buffer of received bytes, either all at once or paced at the		*/
+/*	port's baud rate, and keeps what is written to it.					*/
+/*																		*/
+/************************************************************************/
+
+#ifndef uart_h
+#define uart_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+#define UART_NO_PACING	0	//Baud rate passed to hostUartLoad() for replay as fast as possible
+
+enum {
+	UART_5N1, UART_6N1, UART_7N1, UART_8N1, UART_5N2, UART_6N2, UART_7N2, UART_8N2,
+	UART_5E1, UART_6E1, UART_7E1, UART_8E1, UART_5E2, UART_6E2, UART_7E2, UART_8E2,
+	UART_5O1, UART_6O1, UART_7O1, UART_8O1, UART_5O2, UART_6O2, UART_7O2, UART_8O2
+};
+
+enum {
+	UART_FULL,
+	UART_RX_ONLY,
+	UART_TX_ONLY
+};
+
+typedef struct uart_ uart_t;
+
+uart_t* hostUart(int uart_nr);
+void hostUartLoad(int uart_nr, const uint8_t* data, size_t len, unsigned long wireBaud);
+size_t hostUartRemaining(int uart_nr);
+size_t hostUartWritten(int uart_nr, const uint8_t** data);
+void hostUartClearWritten(int uart_nr);
+
+void uart_swap(uart_t* uart, int tx_pin);
+void uart_set_tx(uart_t* uart, int tx_pin);
+void uart_set_pins(uart_t* uart, int tx, int rx);
+int uart_peek_char(uart_t* uart);
+int uart_read_char(uart_t* uart);
+size_t uart_rx_available(uart_t* uart);
+size_t uart_tx_free(uart_t* uart);
+size_t uart_write_char(uart_t* uart, char c);
+size_t uart_write(uart_t* uart, const char* buf, size_t size);
+bool uart_tx_enabled(uart_t* uart);
+bool uart_rx_enabled(uart_t* uart);
+int uart_get_baudrate(uart_t* uart);
+bool uart_has_overrun(uart_t* uart);
+
+#endif //uart_h
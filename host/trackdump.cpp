@@ -0,0 +1,174 @@
+/************************************************************************/
+/*																		*/
+/*	trackdump.cpp  Reads a GPSTrackLog file back as CSV or NMEA			*/
+/*																		*/
+/************************************************************************/
+/*  Description:														*/
+/*																		*/
+/*	Decodes each block of a track log, as written by replay -l or		*/
+/*	copied from a card or EEPROM, and prints the points oldest block	*/
+/*	first, by sequence number, so a ring such as the sketch's EEPROM	*/
+/*	log comes out in order. Erased or damaged blocks are skipped and	*/
+/*	counted on stderr.													*/
+/*																		*/
+/*	Usage: trackdump [-c | -n] [-s size] [-o offset] file				*/
+/*	  -c		CSV: utc,latitude,longitude,altitude m,speed km/h		*/
+/*				(the default)											*/
+/*	  -n		NMEA: a GGA and a VTG sentence per point				*/
+/*	  -s size	block size the log was written with, default			*/
+/*				TRACK_BLOCK_SIZE										*/
+/*	  -o offset	bytes before the first block, 320 for the sketch's		*/
+/*				EEPROM, where the fix store comes first					*/
+/*																		*/
+/************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+#include "GPSTrackLog.h"
+
+static bool nmea = false;
+static uint16_t newest;	//Sequence number of the newest block read
+
+/* ------------------------------------------------------------ */
+/*  olderBlock()
+**
+**  Description:
+**    Orders blocks by how far their sequence number is behind the
+**	  newest one, so the order survives the numbers wrapping.
+*/
+static bool olderBlock(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b)
+{
+	uint16_t ageA = newest - (uint16_t)(a[2] | a[3] << 8);
+	uint16_t ageB = newest - (uint16_t)(b[2] | b[3] << 8);
+
+	return ageA > ageB;
+}
+
+/* ------------------------------------------------------------ */
+/*  printSentence()
+**
+**  Description:
+**    Prints "$body*hh<CR><LF>" with the checksum of body.
+*/
+static void printSentence(const char* body)
+{
+	uint8_t checksum = 0;
+	const char* p;
+
+	for (p = body; *p; p++){
+		checksum ^= (uint8_t)*p;
+	}
+	printf("$%s*%02X\r\n", body, checksum);
+}
+
+/* ------------------------------------------------------------ */
+/*  coordinate()
+**
+**  Description:
+**    Writes 1e-7 degrees as NMEA ddmm.mmmm,H or dddmm.mmmm,H.
+*/
+static void coordinate(char* out, size_t n, int32_t value, int degreeDigits, char positive, char negative)
+{
+	uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+	uint32_t degrees = magnitude / 10000000;
+	uint32_t minutes = (uint32_t)(((uint64_t)(magnitude % 10000000) * 60 + 500) / 1000);	//1e-4 minutes
+
+	if (minutes >= 600000){//Rounded up to a whole degree
+		minutes -= 600000;
+		degrees++;
+	}
+	snprintf(out, n, "%0*u%02u.%04u,%c", degreeDigits, degrees, minutes / 10000, minutes % 10000, value < 0 ? negative : positive);
+}
+
+static void printPoint(void* context, const TRACK_POINT* point)
+{
+	uint32_t ms = point->UTC;
+	char utc[16], lat[24], lon[24], body[128];
+
+	(void)context;
+	snprintf(utc, sizeof(utc), "%02u%02u%02u.%03u", ms / 3600000 % 24, ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+	if (!nmea){
+		printf("%s,%.7f,%.7f,%.2f,%.3f\n", utc, point->LAT / 1e7, point->LON / 1e7, point->ALT / 100.0, point->SPEED * 0.0036);
+		return;
+	}
+	coordinate(lat, sizeof(lat), point->LAT, 2, 'N', 'S');
+	coordinate(lon, sizeof(lon), point->LON, 3, 'E', 'W');
+	snprintf(body, sizeof(body), "GPGGA,%s,%s,%s,1,,,%.1f,M,,M,,", utc, lat, lon, point->ALT / 100.0);
+	printSentence(body);
+	snprintf(body, sizeof(body), "GPVTG,,T,,M,%.2f,N,%.2f,K,A", point->SPEED / 514.444, point->SPEED * 0.0036);
+	printSentence(body);
+}
+
+int main(int argc, char** argv)
+{
+	unsigned long size = TRACK_BLOCK_SIZE;
+	long offset = 0;
+	unsigned blocks = 0, skipped = 0, points = 0;
+	std::vector<uint8_t> block;
+	std::vector<std::vector<uint8_t> > log;
+	uint16_t sequence;
+	size_t i;
+	FILE* f;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "cno:s:")) != -1){
+		switch(opt){
+			case 'c':nmea = false;
+				break;
+			case 'n':nmea = true;
+				break;
+			case 's':size = strtoul(optarg, NULL, 10);
+				break;
+			case 'o':offset = strtol(optarg, NULL, 10);
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-c | -n] [-s size] [-o offset] file\n", argv[0]);
+				return 1;
+		}
+	}
+	if (optind >= argc || size < TRACK_HEADER_SIZE || size > 0xFFFF || offset < 0){
+		fprintf(stderr, "usage: %s [-c | -n] [-s size] [-o offset] file\n", argv[0]);
+		return 1;
+	}
+	f = fopen(argv[optind], "rb");
+	if (f == NULL || fseek(f, offset, SEEK_SET) != 0){
+		perror(argv[optind]);
+		return 1;
+	}
+
+	block.resize(size);
+	while (fread(block.data(), 1, size, f) == size){
+		blocks++;
+		if (block[0] != TRACK_MAGIC){
+			skipped++;
+			continue;
+		}
+		sequence = block[2] | (uint16_t)block[3] << 8;
+		if (log.empty() || (int16_t)(sequence - newest) > 0){
+			newest = sequence;
+		}
+		log.push_back(block);
+	}
+	fclose(f);
+	std::stable_sort(log.begin(), log.end(), olderBlock);
+
+	if (!nmea){
+		printf("utc,latitude,longitude,altitude,speed\n");
+	}
+	for (i = 0; i < log.size(); i++){
+		int16_t decoded = trackDecodeBlock(log[i].data(), (uint16_t)size, printPoint, NULL, NULL);
+
+		if (decoded != log[i][1]){
+			skipped++;
+		}
+		if (decoded > 0){
+			points += decoded;
+		}
+	}
+	fprintf(stderr, "%u points from %u blocks, %u erased or damaged\n", points, blocks, skipped);
+	return 0;
+}